@@ -35,10 +35,17 @@ extern "C" {
  *  A constructed context can safely be used from multiple threads
  *  simultaneously, but API call that take a non-const pointer to a context
  *  need exclusive access to it. In particular this is the case for
- *  secp256k1_context_destroy and secp256k1_context_randomize.
+ *  secp256k1_context_destroy, and for secp256k1_context_randomize unless the
+ *  library was built with atomic builtins (see below).
  *
  *  Regarding randomization, either do it once at creation time (in which case
  *  you do not need any locking for the other calls), or use a read-write lock.
+ *  If the compiler used to build the library supports the GCC atomic builtins
+ *  (GCC and clang do, and configure checks for them), the randomization is
+ *  replaced without blocking, and secp256k1_context_randomize can run while
+ *  other threads use the same context, e.g. from a thread that re-randomizes
+ *  periodically. Calls running concurrently with it neither wait for it nor
+ *  see partially replaced values; they use either the old or the new ones.
  */
 typedef struct secp256k1_context_struct secp256k1_context;
 
@@ -55,6 +62,41 @@ typedef struct secp256k1_context_struct secp256k1_context;
  */
 typedef struct secp256k1_scratch_space_struct secp256k1_scratch_space;
 
+/** A pointer to a job function, to be run by an executor.
+ *
+ *  In:      job_data: the job_data pointer passed to the executor.
+ *           idx:      the index of the job, in [0, n_jobs).
+ */
+typedef void (*secp256k1_executor_job_function)(
+    void *job_data,
+    size_t idx
+);
+
+/** A pointer to a function that runs independent jobs, e.g. on a thread pool.
+ *
+ *  In:      job:      the job function.
+ *           job_data: pointer to pass to every call of job.
+ *           n_jobs:   the number of jobs.
+ *           data:     Arbitrary data pointer that is passed through.
+ *
+ *  The function must call job(job_data, idx) exactly once for every idx in
+ *  [0, n_jobs), in any order and from any thread, and may only return after all of
+ *  these calls have returned.
+ */
+typedef void (*secp256k1_executor_function)(
+    secp256k1_executor_job_function job,
+    void *job_data,
+    size_t n_jobs,
+    void *data
+);
+
+/** Opaque data structure that holds precomputed multiples of a single public key,
+ *  to speed up repeated signature verification against that key.
+ *
+ *  Once created it is only read from, so it can be shared between threads.
+ */
+typedef struct secp256k1_pubkey_precomp_struct secp256k1_pubkey_precomp;
+
 /** Opaque data structure that holds a parsed and valid public key.
  *
  *  The exact representation of data inside is implementation defined and not
@@ -190,10 +232,32 @@ SECP256K1_API secp256k1_context* secp256k1_context_create(
     unsigned int flags
 ) SECP256K1_WARN_UNUSED_RESULT;
 
+/** Create a secp256k1 context object with a custom verification table size.
+ *
+ *  Returns: a newly created context object, or NULL if flags or window are invalid.
+ *  In:      flags:  which parts of the context to initialize.
+ *           window: window size of the precomputed multiples of the generator used
+ *                   for verification, between 2 and 24. secp256k1_context_create uses
+ *                   15 when built with the endomorphism and 16 otherwise.
+ *
+ *  The tables take 2^(window - 2) * 64 bytes, twice that when built with the
+ *  endomorphism, so they are only allocated if flags contains
+ *  SECP256K1_CONTEXT_VERIFY. Smaller windows save memory at the cost of slower
+ *  verification; larger windows speed up verification slightly.
+ */
+SECP256K1_API secp256k1_context* secp256k1_context_create_with_window(
+    unsigned int flags,
+    int window
+) SECP256K1_WARN_UNUSED_RESULT;
+
 /** Copies a secp256k1 context object.
  *
  *  Returns: a newly created context object.
  *  Args:    ctx: an existing context to copy (cannot be NULL)
+ *
+ *  The precomputed tables are immutable and, where the compiler supports atomic
+ *  reference counting, shared between a context and its copies instead of being
+ *  duplicated. The copy can be randomized independently of the original.
  */
 SECP256K1_API secp256k1_context* secp256k1_context_clone(
     const secp256k1_context* ctx
@@ -256,6 +320,19 @@ SECP256K1_API void secp256k1_context_set_error_callback(
     const void* data
 ) SECP256K1_ARG_NONNULL(1);
 
+/** Get the name of the field and scalar multiplication code in use.
+ *
+ *  Returns: "generic", "x86_64" or "x86_64_bmi2".
+ *  Args: ctx:  an existing context object (cannot be NULL)
+ *
+ *  When the library is built with runtime dispatch, secp256k1_context_create
+ *  switches to the fastest code the CPU supports, for the whole process.
+ *  Otherwise the code is fixed at build time.
+ */
+SECP256K1_API const char* secp256k1_context_get_kernel(
+    const secp256k1_context* ctx
+) SECP256K1_ARG_NONNULL(1);
+
 /** Create a secp256k1 scratch space object.
  *
  *  Returns: a newly created scratch space.
@@ -421,6 +498,74 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify(
     const secp256k1_pubkey *pubkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Verify a batch of ECDSA signatures.
+ *
+ *  Returns: 1: all signatures are correct (also when n is 0)
+ *           0: at least one signature is incorrect or unparseable
+ *  Args:    ctx:       a secp256k1 context object, initialized for verification.
+ *           scratch:   scratch space used to share work between the signatures (cannot be NULL)
+ *  In:      sigs:      array of pointers to the n signatures being verified
+ *           msg32s:    array of pointers to the n 32-byte message hashes being verified
+ *           pubkeys:   array of pointers to the n initialized public keys to verify with
+ *           n:         the number of signatures
+ *
+ *  Equivalent to calling secp256k1_ecdsa_verify on every (sig, msg32, pubkey) triple and
+ *  returning 1 only if all of them succeed, including the lower-S requirement. The modular
+ *  inversions of all signatures are combined into one; the larger the scratch space, the more
+ *  signatures share an inversion. If the scratch space is too small to hold any state, the
+ *  signatures are verified one by one.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify_batch(
+    const secp256k1_context* ctx,
+    secp256k1_scratch_space *scratch,
+    const secp256k1_ecdsa_signature * const *sigs,
+    const unsigned char * const *msg32s,
+    const secp256k1_pubkey * const *pubkeys,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Create precomputed tables for verifying many signatures against one public key.
+ *
+ *  Returns: a newly created precomputed public key object, or NULL if the public key
+ *           was invalid.
+ *  Args: ctx:    a secp256k1 context object (cannot be NULL)
+ *  In:   pubkey: pointer to an initialized public key (cannot be NULL)
+ *
+ *  The object uses about 8 KiB of memory.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_pubkey_precomp* secp256k1_pubkey_precomp_create(
+    const secp256k1_context* ctx,
+    const secp256k1_pubkey *pubkey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Destroy a precomputed public key object.
+ *
+ *  The pointer may not be used afterwards.
+ *  Args:   precomp: object to destroy (can be NULL, in which case nothing happens)
+ */
+SECP256K1_API void secp256k1_pubkey_precomp_destroy(
+    secp256k1_pubkey_precomp* precomp
+);
+
+/** Verify an ECDSA signature using a precomputed public key.
+ *
+ *  Returns: 1: correct signature
+ *           0: incorrect or unparseable signature
+ *  Args:    ctx:     a secp256k1 context object, initialized for verification.
+ *  In:      sig:     the signature being verified (cannot be NULL)
+ *           msg32:   the 32-byte message hash being verified (cannot be NULL)
+ *           precomp: the precomputed public key to verify with (cannot be NULL)
+ *
+ *  Equivalent to secp256k1_ecdsa_verify with the public key precomp was created from,
+ *  including the lower-S requirement, but faster.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify_precomp(
+    const secp256k1_context* ctx,
+    const secp256k1_ecdsa_signature *sig,
+    const unsigned char *msg32,
+    const secp256k1_pubkey_precomp *precomp
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
 /** Convert a signature to a normalized lower-S form.
  *
  *  Returns: 1 if sigin was not normalized, 0 if it already was.
@@ -501,6 +646,37 @@ SECP256K1_API int secp256k1_ecdsa_sign(
     const void *ndata
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Create ECDSA signatures for a batch of messages with the same secret key.
+ *
+ *  Returns: 1: all signatures created (also when n is 0)
+ *           0: the nonce generation function failed, or the private key was invalid. All
+ *              signatures are cleared.
+ *  Args:    ctx:     pointer to a context object, initialized for signing (cannot be NULL)
+ *           scratch: scratch space used to share work between the signatures (cannot be NULL)
+ *  Out:     sigs:    pointer to an array where the n signatures will be placed
+ *  In:      msg32s:  array of pointers to the n 32-byte message hashes being signed
+ *           n:       the number of messages
+ *           seckey:  pointer to a 32-byte secret key (cannot be NULL)
+ *           noncefp: pointer to a nonce generation function. If NULL, secp256k1_nonce_function_default is used
+ *           ndata:   pointer to arbitrary data used by the nonce generation function (can be NULL)
+ *
+ *  Produces the same signatures as calling secp256k1_ecdsa_sign for every message. The
+ *  conversions of the nonce points to affine coordinates and the inversions of the nonces
+ *  are each combined into one (in constant time); the larger the scratch space, the more
+ *  signatures share them. If the scratch space is too small to hold any state, the messages
+ *  are signed one by one.
+ */
+SECP256K1_API int secp256k1_ecdsa_sign_batch(
+    const secp256k1_context* ctx,
+    secp256k1_scratch_space *scratch,
+    secp256k1_ecdsa_signature *sigs,
+    const unsigned char * const *msg32s,
+    size_t n,
+    const unsigned char *seckey,
+    secp256k1_nonce_function noncefp,
+    const void *ndata
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(6);
+
 /** Verify an ECDSA secret key.
  *
  *  Returns: 1: secret key is valid
@@ -527,6 +703,62 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_create(
     const unsigned char *seckey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** Compute the public keys for a batch of secret keys.
+ *
+ *  Returns: 1: all secrets were valid, public keys stored (also when n is 0)
+ *           0: some secret was invalid. All outputs are cleared.
+ *  Args:   ctx:        pointer to a context object, initialized for signing (cannot be NULL)
+ *          scratch:    scratch space used to share work between the keys (cannot be NULL)
+ *  Out:    pubkeys:    pointer to an array where the n public keys will be placed (can be NULL)
+ *          output33:   pointer to a 33*n byte array where the n public keys will be placed
+ *                      in compressed serialized form (can be NULL)
+ *  In:     seckeys:    array of pointers to the n 32-byte private keys
+ *          n:          the number of keys
+ *
+ *  At least one of pubkeys and output33 must be non-NULL. The conversions of the public
+ *  keys to affine coordinates are combined into one (in constant time); the larger the
+ *  scratch space, the more keys share it. If the scratch space is too small to hold any
+ *  state, the keys are converted one by one.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_create_batch(
+    const secp256k1_context* ctx,
+    secp256k1_scratch_space *scratch,
+    secp256k1_pubkey *pubkeys,
+    unsigned char *output33,
+    const unsigned char * const *seckeys,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Compute the public keys for a sequence of consecutive secret keys.
+ *
+ *  Returns: 1: all secrets were valid, public keys stored (also when n is 0)
+ *           0: seckey was invalid, or the sequence would reach the group order. All
+ *              outputs are cleared.
+ *  Args:   ctx:        pointer to a context object, initialized for signing (cannot be NULL)
+ *          scratch:    scratch space used to share work between the keys (cannot be NULL)
+ *  Out:    pubkeys:    pointer to an array where the n public keys will be placed (can be NULL)
+ *          output33:   pointer to a 33*n byte array where the n public keys will be placed
+ *                      in compressed serialized form (can be NULL)
+ *  In:     seckey:     pointer to the 32-byte first private key (cannot be NULL)
+ *          n:          the number of keys
+ *
+ *  Computes the public keys for seckey, seckey+1, ..., seckey+n-1, with the first
+ *  secret key interpreted as a big endian integer. At least one of pubkeys and output33
+ *  must be non-NULL. Only the first key takes a multiplication; every next one takes a
+ *  point addition. For long sequences these are affine additions of multiples of G
+ *  that share a single inversion per batch, and otherwise the conversions to affine
+ *  coordinates are shared as in secp256k1_ec_pubkey_create_batch. A larger scratch
+ *  space allows larger batches.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_create_sequence(
+    const secp256k1_context* ctx,
+    secp256k1_scratch_space *scratch,
+    secp256k1_pubkey *pubkeys,
+    unsigned char *output33,
+    const unsigned char *seckey,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(5);
+
 /** Negates a private key in place.
  *
  *  Returns: 1 always
@@ -570,7 +802,8 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_privkey_tweak_add(
  *          would be invalid (only when the tweak is the complement of the
  *          corresponding private key). 1 otherwise.
  * Args:    ctx:    pointer to a context object initialized for validation
- *                  (cannot be NULL).
+ *                  (cannot be NULL). It is faster if ctx is also initialized
+ *                  for signing.
  * In/Out:  pubkey: pointer to a public key object.
  * In:      tweak:  pointer to a 32-byte tweak.
  */
@@ -580,6 +813,30 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_tweak_add(
     const unsigned char *tweak
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** Tweak a batch of public keys by adding tweak times the generator to each.
+ * Returns: 1 if all public keys were tweaked (also when n is 0). 0 if some tweak was
+ *          out of range or some resulting public key would be invalid, in which case
+ *          those public keys are cleared and all others are tweaked as usual.
+ * Args:    ctx:     pointer to a context object initialized for validation
+ *                   (cannot be NULL).
+ *          scratch: scratch space used to share work between the keys (cannot be NULL)
+ * In/Out:  pubkeys: pointer to an array of n public key objects.
+ * In:      tweaks:  array of pointers to the n 32-byte tweaks, one for each public key.
+ *          n:       the number of public keys.
+ *
+ * Produces the same public keys as calling secp256k1_ec_pubkey_tweak_add for every
+ * public key, but the conversions of the results to affine coordinates are combined
+ * into one; the larger the scratch space, the more keys share it. Like
+ * secp256k1_ec_pubkey_tweak_add, this is faster if ctx is also initialized for signing.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_tweak_add_batch(
+    const secp256k1_context* ctx,
+    secp256k1_scratch_space *scratch,
+    secp256k1_pubkey *pubkeys,
+    const unsigned char * const *tweaks,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
 /** Tweak a private key by multiplying it by a tweak.
  * Returns: 0 if the tweak was out of range (chance of around 1 in 2^128 for
  *          uniformly random 32-byte arrays, or equal to zero. 1 otherwise.
@@ -624,7 +881,9 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_tweak_mul(
  * rely on any input-dependent behaviour.
  *
  * You should call this after secp256k1_context_create or
- * secp256k1_context_clone, and may call this repeatedly afterwards.
+ * secp256k1_context_clone, and may call this repeatedly afterwards. With atomic
+ * builtins this may run concurrently with other calls using ctx, except
+ * secp256k1_context_destroy; see secp256k1_context.
  */
 SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_context_randomize(
     secp256k1_context* ctx,
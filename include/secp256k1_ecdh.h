@@ -7,6 +7,14 @@
 extern "C" {
 #endif
 
+/** Opaque data structure that holds a private key prepared for computing many EC
+ *  Diffie-Hellman secrets with it.
+ *
+ *  Once created it is only read from, so it can be shared between threads. It holds
+ *  the private key in recoded form and must be protected like the key itself.
+ */
+typedef struct secp256k1_ecdh_privkey_precomp_struct secp256k1_ecdh_privkey_precomp;
+
 /** Compute an EC Diffie-Hellman secret in constant time
  *  Returns: 1: exponentiation was successful
  *           0: scalar was invalid (zero or overflow)
@@ -24,6 +32,71 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdh(
   const unsigned char *privkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Prepare a private key for computing many EC Diffie-Hellman secrets with it.
+ *
+ *  Returns: a newly created prepared private key object, or NULL if the private key
+ *           was invalid (zero or overflow).
+ *  Args:    ctx:     pointer to a context object (cannot be NULL)
+ *  In:      privkey: a 32-byte scalar with which to multiply points (cannot be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_ecdh_privkey_precomp* secp256k1_ecdh_privkey_precomp_create(
+  const secp256k1_context* ctx,
+  const unsigned char *privkey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Destroy a prepared private key object, clearing its contents.
+ *
+ *  The pointer may not be used afterwards.
+ *  Args:   precomp: object to destroy (can be NULL, in which case nothing happens)
+ */
+SECP256K1_API void secp256k1_ecdh_privkey_precomp_destroy(
+  secp256k1_ecdh_privkey_precomp* precomp
+);
+
+/** Compute an EC Diffie-Hellman secret in constant time using a prepared private key
+ *  Returns: 1: exponentiation was successful
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ *  Out:     result:     a 32-byte array which will be populated by an ECDH
+ *                       secret computed from the point and scalar
+ *  In:      pubkey:     a pointer to a secp256k1_pubkey containing an
+ *                       initialized public key
+ *           precomp:    the prepared private key to multiply the point with
+ *
+ *  Equivalent to secp256k1_ecdh with the private key precomp was created from, but
+ *  skips recoding the private key on every call.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdh_precomp(
+  const secp256k1_context* ctx,
+  unsigned char *result,
+  const secp256k1_pubkey *pubkey,
+  const secp256k1_ecdh_privkey_precomp *precomp
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
+/** Compute EC Diffie-Hellman secrets of one private key with a batch of public keys
+ *  Returns: 1: exponentiation was successful (also when n is 0)
+ *           0: scalar was invalid (zero or overflow). All outputs are cleared.
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ *           scratch:    scratch space used to share work between the points (cannot be NULL)
+ *  Out:     output32s:  a 32*n byte array which will be populated by the n ECDH
+ *                       secrets computed from the points and scalar
+ *  In:      pubkeys:    array of pointers to the n initialized public keys
+ *           n:          the number of public keys
+ *           privkey:    a 32-byte scalar with which to multiply the points
+ *
+ *  Produces the same secrets as calling secp256k1_ecdh for every public key. The private
+ *  key is recoded once and the conversions of the shared points to affine coordinates
+ *  are combined into one (in constant time); the larger the scratch space, the more
+ *  points share it.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdh_batch(
+  const secp256k1_context* ctx,
+  secp256k1_scratch_space *scratch,
+  unsigned char *output32s,
+  const secp256k1_pubkey * const *pubkeys,
+  size_t n,
+  const unsigned char *privkey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(6);
+
 #ifdef __cplusplus
 }
 #endif
@@ -103,6 +103,68 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_recover(
     const unsigned char *msg32
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Recover the ECDSA public keys of a batch of signatures.
+ *
+ *  Returns: 1: all public keys successfully recovered (also when n is 0)
+ *           0: some public key could not be recovered. Those public keys are cleared;
+ *              all others are recovered as usual.
+ *  Args:    ctx:     pointer to a context object, initialized for verification (cannot be NULL)
+ *           scratch: scratch space used to share work between the signatures (cannot be NULL)
+ *  Out:     pubkeys: pointer to an array where the n recovered public keys will be placed
+ *  In:      sigs:    array of pointers to the n signatures that support pubkey recovery
+ *           msg32s:  array of pointers to the n 32-byte message hashes assumed to be signed
+ *           n:       the number of signatures
+ *
+ *  Produces the same public keys as calling secp256k1_ecdsa_recover for every signature,
+ *  but the inversions of the r values and the conversions of the results to affine
+ *  coordinates are each combined into one; the larger the scratch space, the more
+ *  signatures share them. If the scratch space is too small to hold any state, the keys
+ *  are recovered one by one. To use several threads, see
+ *  secp256k1_ecdsa_recover_batch_parallel.
+ */
+SECP256K1_API int secp256k1_ecdsa_recover_batch(
+    const secp256k1_context* ctx,
+    secp256k1_scratch_space *scratch,
+    secp256k1_pubkey *pubkeys,
+    const secp256k1_ecdsa_recoverable_signature * const *sigs,
+    const unsigned char * const *msg32s,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Recover the ECDSA public keys of a batch of signatures on several threads.
+ *
+ *  Returns: 1: all public keys successfully recovered (also when n is 0)
+ *           0: some public key could not be recovered. Those public keys are cleared;
+ *              all others are recovered as usual.
+ *  Args:    ctx:           pointer to a context object, initialized for verification
+ *                          (cannot be NULL)
+ *           executor:      function that runs the jobs (cannot be NULL)
+ *           executor_data: arbitrary data pointer that is passed through to executor
+ *           scratches:     array of n_scratches scratch spaces, one per job that may run
+ *                          at the same time (cannot be NULL)
+ *           n_scratches:   the number of scratch spaces (must be at least 1)
+ *  Out:     pubkeys:       pointer to an array where the n recovered public keys will be placed
+ *  In:      sigs:          array of pointers to the n signatures that support pubkey recovery
+ *           msg32s:        array of pointers to the n 32-byte message hashes assumed to be signed
+ *           n:             the number of signatures
+ *
+ *  Like secp256k1_ecdsa_recover_batch, but the batches are distributed over up to
+ *  n_scratches jobs which are run through the executor. Job i exclusively uses
+ *  scratches[i], and the first scratch space also holds the state of the jobs. The
+ *  batch size is limited by the smallest scratch space.
+ */
+SECP256K1_API int secp256k1_ecdsa_recover_batch_parallel(
+    const secp256k1_context* ctx,
+    secp256k1_executor_function executor,
+    void *executor_data,
+    secp256k1_scratch_space **scratches,
+    size_t n_scratches,
+    secp256k1_pubkey *pubkeys,
+    const secp256k1_ecdsa_recoverable_signature * const *sigs,
+    const unsigned char * const *msg32s,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(4);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,50 @@
+#ifndef SECP256K1_TABLEFILE_H
+#define SECP256K1_TABLEFILE_H
+
+#include "secp256k1.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Write the precomputed tables of a context to a file.
+ *
+ *  Returns: 1: the file was written
+ *           0: the file could not be written
+ *  Args:    ctx:  a secp256k1 context object, initialized for signing and verification
+ *                 (cannot be NULL)
+ *  In:      path: name of the file to create or overwrite (cannot be NULL)
+ *
+ *  The file is versioned and checksummed, but its contents are specific to the
+ *  configuration of the library that wrote it (field implementation, endomorphism,
+ *  byte order). It can only be loaded by a library built the same way.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_tablefile_write(
+    const secp256k1_context* ctx,
+    const char *path
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Create a secp256k1 context object using tables mapped from a file.
+ *
+ *  Returns: a newly created context object, or NULL if the file cannot be mapped or
+ *           was not written by secp256k1_tablefile_write of a compatible library.
+ *  In:      flags: which parts of the context to initialize.
+ *           path:  name of a file written by secp256k1_tablefile_write (cannot be NULL)
+ *
+ *  The file is mapped read-only and verified against its checksum instead of
+ *  computing the tables, so processes using the same file share its pages. The
+ *  verification window of the context is the one of the context that wrote the
+ *  file. The mapping is released when the context and all its clones are destroyed.
+ *  Anyone who can modify the file controls the results of the context, so it needs
+ *  the same protection as the library itself.
+ */
+SECP256K1_API secp256k1_context* secp256k1_context_create_from_tablefile(
+    unsigned int flags,
+    const char *path
+) SECP256K1_ARG_NONNULL(2) SECP256K1_WARN_UNUSED_RESULT;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SECP256K1_TABLEFILE_H */
@@ -15,12 +15,15 @@
 #undef USE_FIELD_5X52
 #undef USE_FIELD_INV_BUILTIN
 #undef USE_FIELD_INV_NUM
+#undef USE_FIELD_INV_SAFEGCD
 #undef USE_NUM_GMP
 #undef USE_NUM_NONE
+#undef USE_RUNTIME_DISPATCH
 #undef USE_SCALAR_4X64
 #undef USE_SCALAR_8X32
 #undef USE_SCALAR_INV_BUILTIN
 #undef USE_SCALAR_INV_NUM
+#undef USE_SCALAR_INV_SAFEGCD
 
 #define USE_NUM_NONE 1
 #define USE_FIELD_INV_BUILTIN 1
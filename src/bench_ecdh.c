@@ -46,9 +46,40 @@ static void bench_ecdh(void* arg) {
     }
 }
 
+static void bench_ecdh_precomp(void* arg) {
+    int i;
+    unsigned char res[32];
+    bench_ecdh_data *data = (bench_ecdh_data*)arg;
+    secp256k1_ecdh_privkey_precomp *precomp = secp256k1_ecdh_privkey_precomp_create(data->ctx, data->scalar);
+
+    CHECK(precomp != NULL);
+    for (i = 0; i < 20000; i++) {
+        CHECK(secp256k1_ecdh_precomp(data->ctx, res, &data->point, precomp) == 1);
+    }
+    secp256k1_ecdh_privkey_precomp_destroy(precomp);
+}
+
+static void bench_ecdh_batch(void* arg) {
+    int i, j;
+    unsigned char res[64 * 32];
+    const secp256k1_pubkey *points[64];
+    bench_ecdh_data *data = (bench_ecdh_data*)arg;
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(data->ctx, 1024 * 1024);
+
+    for (j = 0; j < 64; j++) {
+        points[j] = &data->point;
+    }
+    for (i = 0; i < 20000 / 64; i++) {
+        CHECK(secp256k1_ecdh_batch(data->ctx, scratch, res, points, 64, data->scalar) == 1);
+    }
+    secp256k1_scratch_space_destroy(scratch);
+}
+
 int main(void) {
     bench_ecdh_data data;
 
     run_benchmark("ecdh", bench_ecdh, bench_ecdh_setup, NULL, &data, 10, 20000);
+    run_benchmark("ecdh_precomp", bench_ecdh_precomp, bench_ecdh_setup, NULL, &data, 10, 20000);
+    run_benchmark("ecdh_batch", bench_ecdh_batch, bench_ecdh_setup, NULL, &data, 10, 20000 / 64 * 64);
     return 0;
 }
@@ -25,6 +25,7 @@ typedef struct {
     secp256k1_gej gej_x, gej_y;
     unsigned char data[64];
     int wnaf[256];
+    secp256k1_context *ctx;
 } bench_inv;
 
 void bench_setup(void* arg) {
@@ -256,6 +257,25 @@ void bench_wnaf_const(void* arg) {
     }
 }
 
+void bench_ecmult_gen(void* arg) {
+    int i;
+    bench_inv *data = (bench_inv*)arg;
+
+    for (i = 0; i < 2000; i++) {
+        secp256k1_ecmult_gen(&data->ctx->ecmult_gen_ctx, &data->gej_x, &data->scalar_x);
+        secp256k1_scalar_add(&data->scalar_x, &data->scalar_x, &data->scalar_y);
+    }
+}
+
+void bench_ecmult_const(void* arg) {
+    int i;
+    bench_inv *data = (bench_inv*)arg;
+
+    for (i = 0; i < 2000; i++) {
+        secp256k1_ecmult_const(&data->gej_x, &data->ge_x, &data->scalar_x, 256);
+        secp256k1_scalar_add(&data->scalar_x, &data->scalar_x, &data->scalar_y);
+    }
+}
 
 void bench_sha256(void* arg) {
     int i;
@@ -326,6 +346,8 @@ void bench_num_jacobi(void* arg) {
 
 int main(int argc, char **argv) {
     bench_inv data;
+    /* Use the same kernels as a context would. */
+    secp256k1_kernel_select();
     if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "add")) run_benchmark("scalar_add", bench_scalar_add, bench_setup, NULL, &data, 10, 2000000);
     if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "negate")) run_benchmark("scalar_negate", bench_scalar_negate, bench_setup, NULL, &data, 10, 2000000);
     if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "sqr")) run_benchmark("scalar_sqr", bench_scalar_sqr, bench_setup, NULL, &data, 10, 200000);
@@ -352,6 +374,12 @@ int main(int argc, char **argv) {
 
     if (have_flag(argc, argv, "ecmult") || have_flag(argc, argv, "wnaf")) run_benchmark("wnaf_const", bench_wnaf_const, bench_setup, NULL, &data, 10, 20000);
     if (have_flag(argc, argv, "ecmult") || have_flag(argc, argv, "wnaf")) run_benchmark("ecmult_wnaf", bench_ecmult_wnaf, bench_setup, NULL, &data, 10, 20000);
+    if (have_flag(argc, argv, "ecmult") || have_flag(argc, argv, "const")) run_benchmark("ecmult_const", bench_ecmult_const, bench_setup, NULL, &data, 10, 2000);
+    if (have_flag(argc, argv, "ecmult") || have_flag(argc, argv, "gen")) {
+        data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+        run_benchmark("ecmult_gen", bench_ecmult_gen, bench_setup, NULL, &data, 10, 2000);
+        secp256k1_context_destroy(data.ctx);
+    }
 
     if (have_flag(argc, argv, "hash") || have_flag(argc, argv, "sha256")) run_benchmark("hash_sha256", bench_sha256, bench_setup, NULL, &data, 10, 20000);
     if (have_flag(argc, argv, "hash") || have_flag(argc, argv, "hmac")) run_benchmark("hash_hmac_sha256", bench_hmac_sha256, bench_setup, NULL, &data, 10, 20000);
@@ -4,13 +4,18 @@
  * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
  **********************************************************************/
 
+#include <string.h>
+
 #include "include/secp256k1.h"
 #include "include/secp256k1_recovery.h"
 #include "util.h"
 #include "bench.h"
 
+#define BATCH_SIZE 64
+
 typedef struct {
     secp256k1_context *ctx;
+    secp256k1_scratch_space *scratch;
     unsigned char msg[32];
     unsigned char sig[64];
 } bench_recover_data;
@@ -36,6 +41,35 @@ void bench_recover(void* arg) {
     }
 }
 
+void bench_recover_batch(void* arg) {
+    int i, j;
+    bench_recover_data *data = (bench_recover_data*)arg;
+    secp256k1_pubkey pubkey[BATCH_SIZE];
+    secp256k1_ecdsa_recoverable_signature sig[BATCH_SIZE];
+    const secp256k1_ecdsa_recoverable_signature *sigptr[BATCH_SIZE];
+    unsigned char msg[BATCH_SIZE][32];
+    const unsigned char *msgptr[BATCH_SIZE];
+    unsigned char pubkeyc[33];
+
+    for (i = 0; i < 20000 / BATCH_SIZE; i++) {
+        size_t pubkeylen = 33;
+        for (j = 0; j < BATCH_SIZE; j++) {
+            CHECK(secp256k1_ecdsa_recoverable_signature_parse_compact(data->ctx, &sig[j], data->sig, j % 2));
+            memcpy(msg[j], data->msg, 32);
+            msg[j][31] ^= j;
+            sigptr[j] = &sig[j];
+            msgptr[j] = msg[j];
+        }
+        CHECK(secp256k1_ecdsa_recover_batch(data->ctx, data->scratch, pubkey, sigptr, msgptr, BATCH_SIZE));
+        CHECK(secp256k1_ec_pubkey_serialize(data->ctx, pubkeyc, &pubkeylen, &pubkey[BATCH_SIZE - 1], SECP256K1_EC_COMPRESSED));
+        for (j = 0; j < 32; j++) {
+            data->sig[j + 32] = data->msg[j];    /* Move former message to S. */
+            data->msg[j] = data->sig[j];         /* Move former R to message. */
+            data->sig[j] = pubkeyc[j + 1];       /* Move recovered pubkey X coordinate to R (which must be a valid X coordinate). */
+        }
+    }
+}
+
 void bench_recover_setup(void* arg) {
     int i;
     bench_recover_data *data = (bench_recover_data*)arg;
@@ -53,8 +87,12 @@ int main(void) {
 
     data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
 
+    data.scratch = secp256k1_scratch_space_create(data.ctx, 1024 * 1024);
+
     run_benchmark("ecdsa_recover", bench_recover, bench_recover_setup, NULL, &data, 10, 20000);
+    run_benchmark("ecdsa_recover_batch", bench_recover_batch, bench_recover_setup, NULL, &data, 10, 20000 / BATCH_SIZE * BATCH_SIZE);
 
+    secp256k1_scratch_space_destroy(data.scratch);
     secp256k1_context_destroy(data.ctx);
     return 0;
 }
@@ -4,14 +4,20 @@
  * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
  **********************************************************************/
 
+#include <string.h>
+
 #include "include/secp256k1.h"
 #include "util.h"
 #include "bench.h"
 
+#define BATCH_SIZE 64
+
 typedef struct {
     secp256k1_context* ctx;
+    secp256k1_scratch_space *scratch;
     unsigned char msg[32];
     unsigned char key[32];
+    unsigned char msgs[BATCH_SIZE][32];
 } bench_sign;
 
 static void bench_sign_setup(void* arg) {
@@ -44,13 +50,37 @@ static void bench_sign_run(void* arg) {
     }
 }
 
+static void bench_sign_batch_run(void* arg) {
+    int i, j;
+    bench_sign *data = (bench_sign*)arg;
+    const unsigned char *msgptr[BATCH_SIZE];
+    secp256k1_ecdsa_signature signature[BATCH_SIZE];
+
+    for (j = 0; j < BATCH_SIZE; j++) {
+        memcpy(data->msgs[j], data->msg, 32);
+        data->msgs[j][0] ^= j;
+        msgptr[j] = data->msgs[j];
+    }
+    for (i = 0; i < 20000 / BATCH_SIZE; i++) {
+        CHECK(secp256k1_ecdsa_sign_batch(data->ctx, data->scratch, signature, msgptr, BATCH_SIZE, data->key, NULL, NULL));
+        for (j = 0; j < 32; j++) {
+            data->msgs[i % BATCH_SIZE][j] = signature[BATCH_SIZE - 1].data[j];
+            data->key[j] = signature[BATCH_SIZE - 1].data[j + 32];
+        }
+    }
+}
+
 int main(void) {
     bench_sign data;
 
     data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
 
+    data.scratch = secp256k1_scratch_space_create(data.ctx, 1024 * 1024);
+
     run_benchmark("ecdsa_sign", bench_sign_run, bench_sign_setup, NULL, &data, 10, 20000);
+    run_benchmark("ecdsa_sign_batch", bench_sign_batch_run, bench_sign_setup, NULL, &data, 10, 20000 / BATCH_SIZE * BATCH_SIZE);
 
+    secp256k1_scratch_space_destroy(data.scratch);
     secp256k1_context_destroy(data.ctx);
     return 0;
 }
@@ -0,0 +1,43 @@
+/**********************************************************************
+ * Copyright (c) 2018 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef SECP256K1_DISPATCH_H
+#define SECP256K1_DISPATCH_H
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+/** Kernels for the 5x52 field multiplication and squaring, and for the 512-bit products of the 4x64
+ *  scalar multiplication and squaring.
+ *
+ *  Without USE_RUNTIME_DISPATCH only the kernel selected at configure time is built. With it,
+ *  all of them are built and one is chosen at runtime for the whole process: the plain x86_64
+ *  assembly until secp256k1_kernel_select runs, then the fastest one the CPU supports.
+ */
+#define SECP256K1_KERNEL_GENERIC 0
+#define SECP256K1_KERNEL_X86_64 1
+#define SECP256K1_KERNEL_BMI2 2
+
+/** Get the kernel in use. */
+static int secp256k1_kernel_get(void);
+
+/** Get the name of a kernel. */
+static const char *secp256k1_kernel_name(int kernel);
+
+/** Switch to the fastest kernel this CPU supports. Concurrent calls are fine, as they all switch
+ *  to the same kernel, and every kernel computes the same results. */
+static void secp256k1_kernel_select(void);
+
+#ifdef USE_RUNTIME_DISPATCH
+/** Whether this CPU supports a kernel. */
+static int secp256k1_kernel_supported(int kernel);
+
+/** Switch to a kernel this CPU supports. */
+static void secp256k1_kernel_set(int kernel);
+#endif
+
+#endif /* SECP256K1_DISPATCH_H */
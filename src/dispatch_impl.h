@@ -0,0 +1,73 @@
+/**********************************************************************
+ * Copyright (c) 2018 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef SECP256K1_DISPATCH_IMPL_H
+#define SECP256K1_DISPATCH_IMPL_H
+
+#include "util.h"
+#include "dispatch.h"
+
+#ifdef USE_RUNTIME_DISPATCH
+static int secp256k1_kernel = SECP256K1_KERNEL_X86_64;
+
+static int secp256k1_kernel_supported(int kernel) {
+    switch (kernel) {
+    case SECP256K1_KERNEL_GENERIC:
+    case SECP256K1_KERNEL_X86_64:
+        return 1;
+    case SECP256K1_KERNEL_BMI2:
+        return __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx");
+    default:
+        return 0;
+    }
+}
+
+static void secp256k1_kernel_set(int kernel) {
+    VERIFY_CHECK(secp256k1_kernel_supported(kernel));
+#ifdef HAVE_BUILTIN_ATOMICS
+    __atomic_store_n(&secp256k1_kernel, kernel, __ATOMIC_RELAXED);
+#else
+    secp256k1_kernel = kernel;
+#endif
+}
+#endif
+
+SECP256K1_INLINE static int secp256k1_kernel_get(void) {
+#if defined(USE_RUNTIME_DISPATCH)
+#ifdef HAVE_BUILTIN_ATOMICS
+    return __atomic_load_n(&secp256k1_kernel, __ATOMIC_RELAXED);
+#else
+    return secp256k1_kernel;
+#endif
+#elif defined(USE_ASM_X86_64)
+    return SECP256K1_KERNEL_X86_64;
+#else
+    return SECP256K1_KERNEL_GENERIC;
+#endif
+}
+
+static const char *secp256k1_kernel_name(int kernel) {
+    switch (kernel) {
+    case SECP256K1_KERNEL_X86_64:
+        return "x86_64";
+    case SECP256K1_KERNEL_BMI2:
+        return "x86_64_bmi2";
+    default:
+        return "generic";
+    }
+}
+
+static void secp256k1_kernel_select(void) {
+#ifdef USE_RUNTIME_DISPATCH
+    if (secp256k1_kernel_supported(SECP256K1_KERNEL_BMI2)) {
+        secp256k1_kernel_set(SECP256K1_KERNEL_BMI2);
+    } else {
+        secp256k1_kernel_set(SECP256K1_KERNEL_X86_64);
+    }
+#endif
+}
+
+#endif /* SECP256K1_DISPATCH_IMPL_H */
@@ -13,6 +13,7 @@
 #include "field.h"
 #include "group.h"
 #include "ecmult_gen.h"
+#include "ecmult_const.h"
 
 static int secp256k1_eckey_pubkey_parse(secp256k1_ge *elem, const unsigned char *pub, size_t size) {
     if (size == 33 && (pub[0] == SECP256K1_TAG_PUBKEY_EVEN || pub[0] == SECP256K1_TAG_PUBKEY_ODD)) {
@@ -60,12 +61,22 @@ static int secp256k1_eckey_privkey_tweak_add(secp256k1_scalar *key, const secp25
     return 1;
 }
 
-static int secp256k1_eckey_pubkey_tweak_add(const secp256k1_ecmult_context *ctx, secp256k1_ge *key, const secp256k1_scalar *tweak) {
+static void secp256k1_eckey_pubkey_tweak_add_var(const secp256k1_ecmult_context *ctx, const secp256k1_ecmult_gen_context *gen_ctx, secp256k1_gej *r, const secp256k1_ge *key, const secp256k1_scalar *tweak) {
+    secp256k1_gej tg;
+    /* Only the tweak needs a multiplication; the key is added once at the end. The
+     * comb of the signing tables needs far fewer doublings than the wNAF, so it is
+     * faster even though it runs in constant time. */
+    if (gen_ctx != NULL && secp256k1_ecmult_gen_context_is_built(gen_ctx)) {
+        secp256k1_ecmult_gen(gen_ctx, &tg, tweak);
+    } else {
+        secp256k1_ecmult_g_var(ctx, &tg, tweak);
+    }
+    secp256k1_gej_add_ge_var(r, &tg, key, NULL);
+}
+
+static int secp256k1_eckey_pubkey_tweak_add(const secp256k1_ecmult_context *ctx, const secp256k1_ecmult_gen_context *gen_ctx, secp256k1_ge *key, const secp256k1_scalar *tweak) {
     secp256k1_gej pt;
-    secp256k1_scalar one;
-    secp256k1_gej_set_ge(&pt, key);
-    secp256k1_scalar_set_int(&one, 1);
-    secp256k1_ecmult(ctx, &pt, &pt, &one, tweak);
+    secp256k1_eckey_pubkey_tweak_add_var(ctx, gen_ctx, &pt, key, tweak);
 
     if (secp256k1_gej_is_infinity(&pt)) {
         return 0;
@@ -83,16 +94,14 @@ static int secp256k1_eckey_privkey_tweak_mul(secp256k1_scalar *key, const secp25
     return 1;
 }
 
-static int secp256k1_eckey_pubkey_tweak_mul(const secp256k1_ecmult_context *ctx, secp256k1_ge *key, const secp256k1_scalar *tweak) {
-    secp256k1_scalar zero;
+static int secp256k1_eckey_pubkey_tweak_mul(secp256k1_ge *key, const secp256k1_scalar *tweak) {
     secp256k1_gej pt;
     if (secp256k1_scalar_is_zero(tweak)) {
         return 0;
     }
 
-    secp256k1_scalar_set_int(&zero, 0);
-    secp256k1_gej_set_ge(&pt, key);
-    secp256k1_ecmult(ctx, &pt, &pt, tweak, &zero);
+    /* The tweak may be secret (e.g. a shared secret), so multiply in constant time. */
+    secp256k1_ecmult_const(&pt, key, tweak, 256);
     secp256k1_ge_set_gej(key, &pt);
     return 1;
 }
@@ -18,10 +18,12 @@ typedef struct {
 #ifdef USE_ENDOMORPHISM
     secp256k1_ge_storage (*pre_g_128)[]; /* odd multiples of 2^128*generator */
 #endif
+    int window_g;                        /* window size the tables were built for */
+    secp256k1_refcount *refcount;        /* shared ownership of the tables, NULL if static */
 } secp256k1_ecmult_context;
 
 static void secp256k1_ecmult_context_init(secp256k1_ecmult_context *ctx);
-static void secp256k1_ecmult_context_build(secp256k1_ecmult_context *ctx, const secp256k1_callback *cb);
+static void secp256k1_ecmult_context_build(secp256k1_ecmult_context *ctx, int window_g, const secp256k1_callback *cb);
 static void secp256k1_ecmult_context_clone(secp256k1_ecmult_context *dst,
                                            const secp256k1_ecmult_context *src, const secp256k1_callback *cb);
 static void secp256k1_ecmult_context_clear(secp256k1_ecmult_context *ctx);
@@ -30,6 +32,25 @@ static int secp256k1_ecmult_context_is_built(const secp256k1_ecmult_context *ctx
 /** Double multiply: R = na*A + ng*G */
 static void secp256k1_ecmult(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng);
 
+/** Generator multiply: R = ng*G, in variable time, using the tables of the context. */
+static void secp256k1_ecmult_g_var(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_scalar *ng);
+
+/** Precomputed odd multiples of a single fixed point A, for repeated evaluation of
+ *  na*A + ng*G without rebuilding the table of A on every call. */
+typedef struct {
+    secp256k1_ge_storage (*pre_a)[];     /* odd multiples of A */
+#ifdef USE_ENDOMORPHISM
+    secp256k1_ge_storage (*pre_a_lam)[]; /* odd multiples of lambda*A */
+#endif
+} secp256k1_ecmult_point_table;
+
+static void secp256k1_ecmult_point_table_init(secp256k1_ecmult_point_table *tbl);
+static void secp256k1_ecmult_point_table_build(secp256k1_ecmult_point_table *tbl, const secp256k1_ge *a, const secp256k1_callback *cb);
+static void secp256k1_ecmult_point_table_clear(secp256k1_ecmult_point_table *tbl);
+
+/** Double multiply with a precomputed table for A: R = na*A + ng*G */
+static void secp256k1_ecmult_with_table(const secp256k1_ecmult_context *ctx, const secp256k1_ecmult_point_table *tbl, secp256k1_gej *r, const secp256k1_scalar *na, const secp256k1_scalar *ng);
+
 typedef int (secp256k1_ecmult_multi_callback)(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data);
 
 /**
@@ -44,4 +65,27 @@ typedef int (secp256k1_ecmult_multi_callback)(secp256k1_scalar *sc, secp256k1_ge
  */
 static int secp256k1_ecmult_multi_var(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n);
 
+/** A job that can be run by an executor. It is called once for every idx in [0, n_jobs). */
+typedef void (secp256k1_executor_job)(void *job_data, size_t idx);
+
+/** Caller-supplied executor used to run independent jobs, possibly in parallel.
+ *  run(job, job_data, n_jobs, data) must call job(job_data, idx) exactly once for
+ *  every idx in [0, n_jobs), in any order and from any thread, and may only return
+ *  after all of these calls have returned. */
+typedef struct {
+    void (*run)(secp256k1_executor_job *job, void *job_data, size_t n_jobs, void *data);
+    void *data;
+} secp256k1_executor;
+
+/**
+ * Parallel multi-multiply: like secp256k1_ecmult_multi_var, but the batches of
+ * points are distributed over n_scratch workers which are run through the
+ * executor. Worker i exclusively uses scratch[i]; the callback may be called
+ * concurrently from different workers and must therefore be thread-safe.
+ * Returns: 1 on success (including when inp_g_sc is NULL and n is 0)
+ *          0 if there is not enough scratch space for a single point in every
+ *          scratch space, or if the callback returns 0
+ */
+static int secp256k1_ecmult_multi_var_parallel(const secp256k1_ecmult_context *ctx, const secp256k1_executor *executor, secp256k1_scratch **scratch, size_t n_scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n);
+
 #endif /* SECP256K1_ECMULT_H */
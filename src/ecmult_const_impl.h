@@ -117,40 +117,60 @@ static int secp256k1_wnaf_const(int *wnaf, secp256k1_scalar s, int w, int size)
     return skew;
 }
 
-static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, const secp256k1_scalar *scalar, int size) {
-    secp256k1_ge pre_a[ECMULT_TABLE_SIZE(WINDOW_A)];
-    secp256k1_ge tmpa;
-    secp256k1_fe Z;
-
+/** A scalar in the form secp256k1_ecmult_const_recoded multiplies with. It only depends
+ *  on the scalar, so multiplying several points with the same scalar can share it. */
+typedef struct {
+    int wnaf_1[1 + WNAF_SIZE(WINDOW_A - 1)];
     int skew_1;
 #ifdef USE_ENDOMORPHISM
-    secp256k1_ge pre_a_lam[ECMULT_TABLE_SIZE(WINDOW_A)];
     int wnaf_lam[1 + WNAF_SIZE(WINDOW_A - 1)];
     int skew_lam;
-    secp256k1_scalar q_1, q_lam;
 #endif
-    int wnaf_1[1 + WNAF_SIZE(WINDOW_A - 1)];
+    int size;
+} secp256k1_ecmult_const_recoding;
 
-    int i;
+static void secp256k1_ecmult_const_recode(secp256k1_ecmult_const_recoding *rec, const secp256k1_scalar *scalar, int size) {
     secp256k1_scalar sc = *scalar;
+#ifdef USE_ENDOMORPHISM
+    secp256k1_scalar q_1, q_lam;
+#endif
 
-    /* build wnaf representation for q. */
-    int rsize = size;
+    rec->size = size;
 #ifdef USE_ENDOMORPHISM
     if (size > 128) {
-        rsize = 128;
         /* split q into q_1 and q_lam (where q = q_1 + q_lam*lambda, and q_1 and q_lam are ~128 bit) */
         secp256k1_scalar_split_lambda(&q_1, &q_lam, &sc);
-        skew_1   = secp256k1_wnaf_const(wnaf_1,   q_1,   WINDOW_A - 1, 128);
-        skew_lam = secp256k1_wnaf_const(wnaf_lam, q_lam, WINDOW_A - 1, 128);
+        rec->skew_1   = secp256k1_wnaf_const(rec->wnaf_1,   q_1,   WINDOW_A - 1, 128);
+        rec->skew_lam = secp256k1_wnaf_const(rec->wnaf_lam, q_lam, WINDOW_A - 1, 128);
+        secp256k1_scalar_clear(&q_1);
+        secp256k1_scalar_clear(&q_lam);
     } else
 #endif
     {
-        skew_1   = secp256k1_wnaf_const(wnaf_1, sc, WINDOW_A - 1, size);
+        rec->skew_1   = secp256k1_wnaf_const(rec->wnaf_1, sc, WINDOW_A - 1, size);
 #ifdef USE_ENDOMORPHISM
-        skew_lam = 0;
+        rec->skew_lam = 0;
 #endif
     }
+    secp256k1_scalar_clear(&sc);
+}
+
+static void secp256k1_ecmult_const_recoded(secp256k1_gej *r, const secp256k1_ge *a, const secp256k1_ecmult_const_recoding *rec) {
+    secp256k1_ge pre_a[ECMULT_TABLE_SIZE(WINDOW_A)];
+    secp256k1_ge tmpa;
+    secp256k1_fe Z;
+#ifdef USE_ENDOMORPHISM
+    secp256k1_ge pre_a_lam[ECMULT_TABLE_SIZE(WINDOW_A)];
+#endif
+
+    int i;
+    int size = rec->size;
+    int rsize = size;
+#ifdef USE_ENDOMORPHISM
+    if (size > 128) {
+        rsize = 128;
+    }
+#endif
 
     /* Calculate odd multiples of a.
      * All multiples are brought to the same Z 'denominator', which is stored
@@ -174,13 +194,13 @@ static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, cons
     /* first loop iteration (separated out so we can directly set r, rather
      * than having it start at infinity, get doubled several times, then have
      * its new value added to it) */
-    i = wnaf_1[WNAF_SIZE_BITS(rsize, WINDOW_A - 1)];
+    i = rec->wnaf_1[WNAF_SIZE_BITS(rsize, WINDOW_A - 1)];
     VERIFY_CHECK(i != 0);
     ECMULT_CONST_TABLE_GET_GE(&tmpa, pre_a, i, WINDOW_A);
     secp256k1_gej_set_ge(r, &tmpa);
 #ifdef USE_ENDOMORPHISM
     if (size > 128) {
-        i = wnaf_lam[WNAF_SIZE_BITS(rsize, WINDOW_A - 1)];
+        i = rec->wnaf_lam[WNAF_SIZE_BITS(rsize, WINDOW_A - 1)];
         VERIFY_CHECK(i != 0);
         ECMULT_CONST_TABLE_GET_GE(&tmpa, pre_a_lam, i, WINDOW_A);
         secp256k1_gej_add_ge(r, r, &tmpa);
@@ -194,13 +214,13 @@ static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, cons
             secp256k1_gej_double_nonzero(r, r, NULL);
         }
 
-        n = wnaf_1[i];
+        n = rec->wnaf_1[i];
         ECMULT_CONST_TABLE_GET_GE(&tmpa, pre_a, n, WINDOW_A);
         VERIFY_CHECK(n != 0);
         secp256k1_gej_add_ge(r, r, &tmpa);
 #ifdef USE_ENDOMORPHISM
         if (size > 128) {
-            n = wnaf_lam[i];
+            n = rec->wnaf_lam[i];
             ECMULT_CONST_TABLE_GET_GE(&tmpa, pre_a_lam, n, WINDOW_A);
             VERIFY_CHECK(n != 0);
             secp256k1_gej_add_ge(r, r, &tmpa);
@@ -211,47 +231,30 @@ static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, cons
     secp256k1_fe_mul(&r->z, &r->z, &Z);
 
     {
-        /* Correct for wNAF skew */
-        secp256k1_ge correction = *a;
-        secp256k1_ge_storage correction_1_stor;
-#ifdef USE_ENDOMORPHISM
-        secp256k1_ge_storage correction_lam_stor;
-#endif
-        secp256k1_ge_storage a2_stor;
+        /* Correct for wNAF skew by subtracting a once, and once more if the skew is 2.
+         * secp256k1_gej_add_ge handles every case in constant time, so unlike adding
+         * 2*a this needs no conversion to affine coordinates. */
+        secp256k1_ge correction;
         secp256k1_gej tmpj;
-        secp256k1_gej_set_ge(&tmpj, &correction);
-        secp256k1_gej_double_var(&tmpj, &tmpj, NULL);
-        secp256k1_ge_set_gej(&correction, &tmpj);
-        secp256k1_ge_to_storage(&correction_1_stor, a);
-#ifdef USE_ENDOMORPHISM
-        if (size > 128) {
-            secp256k1_ge_to_storage(&correction_lam_stor, a);
-        }
-#endif
-        secp256k1_ge_to_storage(&a2_stor, &correction);
-
-        /* For odd numbers this is 2a (so replace it), for even ones a (so no-op) */
-        secp256k1_ge_storage_cmov(&correction_1_stor, &a2_stor, skew_1 == 2);
-#ifdef USE_ENDOMORPHISM
-        if (size > 128) {
-            secp256k1_ge_storage_cmov(&correction_lam_stor, &a2_stor, skew_lam == 2);
-        }
-#endif
-
-        /* Apply the correction */
-        secp256k1_ge_from_storage(&correction, &correction_1_stor);
-        secp256k1_ge_neg(&correction, &correction);
+        secp256k1_ge_neg(&correction, a);
         secp256k1_gej_add_ge(r, r, &correction);
-
+        secp256k1_gej_add_ge(&tmpj, r, &correction);
+        secp256k1_gej_cmov(r, &tmpj, rec->skew_1 == 2);
 #ifdef USE_ENDOMORPHISM
         if (size > 128) {
-            secp256k1_ge_from_storage(&correction, &correction_lam_stor);
-            secp256k1_ge_neg(&correction, &correction);
             secp256k1_ge_mul_lambda(&correction, &correction);
             secp256k1_gej_add_ge(r, r, &correction);
+            secp256k1_gej_add_ge(&tmpj, r, &correction);
+            secp256k1_gej_cmov(r, &tmpj, rec->skew_lam == 2);
         }
 #endif
     }
 }
 
+static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, const secp256k1_scalar *scalar, int size) {
+    secp256k1_ecmult_const_recoding rec;
+    secp256k1_ecmult_const_recode(&rec, scalar, size);
+    secp256k1_ecmult_const_recoded(r, a, &rec);
+}
+
 #endif /* SECP256K1_ECMULT_CONST_IMPL_H */
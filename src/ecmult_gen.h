@@ -10,22 +10,66 @@
 #include "scalar.h"
 #include "group.h"
 
+/* Signed-digit multi-comb parameters: the scalar is processed as COMB_BLOCKS blocks of
+ * COMB_TEETH teeth each, spaced COMB_SPACING bits apart. A multiplication takes
+ * COMB_BLOCKS * COMB_SPACING additions and COMB_SPACING - 1 doublings, and the table
+ * holds COMB_BLOCKS * 2^(COMB_TEETH - 1) points. */
+#ifdef EXHAUSTIVE_TEST_ORDER
+/* Table entries must not be infinity, which small configurations guarantee for the
+ * exhaustive test groups. */
+#  undef COMB_BLOCKS
+#  undef COMB_TEETH
+#  define COMB_BLOCKS 2
+#  define COMB_TEETH 2
+#  if EXHAUSTIVE_TEST_ORDER < 16
+#    define COMB_RANGE 4
+#  elif EXHAUSTIVE_TEST_ORDER < 256
+#    define COMB_RANGE 8
+#  else
+#    error Unsupported EXHAUSTIVE_TEST_ORDER
+#  endif
+#else
+#  define COMB_RANGE 256
+#endif
+
+#ifndef COMB_BLOCKS
+#  define COMB_BLOCKS 11
+#endif
+#ifndef COMB_TEETH
+#  define COMB_TEETH 6
+#endif
+
+#if COMB_BLOCKS < 1 || COMB_BLOCKS > 256
+#  error Set COMB_BLOCKS to a value in the range [1,256]
+#endif
+#if COMB_TEETH < 1 || COMB_TEETH > 8
+#  error Set COMB_TEETH to a value in the range [1,8]
+#endif
+
+#define COMB_SPACING ((COMB_RANGE + COMB_BLOCKS * COMB_TEETH - 1) / (COMB_BLOCKS * COMB_TEETH))
+#define COMB_BITS (COMB_BLOCKS * COMB_TEETH * COMB_SPACING)
+#define COMB_POINTS (1 << (COMB_TEETH - 1))
+
 typedef struct {
     /* For accelerating the computation of a*G:
-     * To harden against timing attacks, use the following mechanism:
-     * * Break up the multiplicand into groups of 4 bits, called n_0, n_1, n_2, ..., n_63.
-     * * Compute sum(n_i * 16^i * G + U_i, i=0..63), where:
-     *   * U_i = U * 2^i (for i=0..62)
-     *   * U_i = U * (1-2^63) (for i=63)
-     *   where U is a point with no known corresponding scalar. Note that sum(U_i, i=0..63) = 0.
-     * For each i, and each of the 16 possible values of n_i, (n_i * 16^i * G + U_i) is
-     * precomputed (call it prec(i, n_i)). The formula now becomes sum(prec(i, n_i), i=0..63).
-     * None of the resulting prec group elements have a known scalar, and neither do any of
-     * the intermediate sums while computing a*G.
+     * Write the scalar d to multiply (a plus the blinding) in binary as sum(d_i * 2^i), and
+     * use signed digits s_i = 2*d_i - 1 in {-1,1}, so that sum(s_i * 2^i * H) = d*G - C,
+     * where H = G/2 and C = (2^COMB_BITS - 1) * H. Bit i = t*COMB_SPACING + k of block b
+     * (with t the tooth, counting the blocks' teeth consecutively) contributes to the k-th
+     * of COMB_SPACING rounds, which are combined by doubling in between.
+     * For each block and each combination of the signs of its lowest COMB_TEETH - 1 teeth,
+     * the sum of +-2^(t*COMB_SPACING) * H over its teeth at k = 0 is precomputed, with the
+     * top tooth positive. The other half of the combinations are their negations. C and
+     * the blinding are compensated for by the initial point.
      */
-    secp256k1_ge_storage (*prec)[64][16]; /* prec[j][i] = 16^j * i * G + U_i */
-    secp256k1_scalar blind;
-    secp256k1_gej initial;
+    secp256k1_ge_storage (*prec)[COMB_BLOCKS][COMB_POINTS];
+    secp256k1_refcount *refcount;         /* shared ownership of prec, NULL if static */
+    /* The blinding is double-buffered under a sequence lock, so that
+     * secp256k1_ecmult_gen_blind can run while other threads multiply. The copy in use is
+     * secp256k1_seqlock_slot(seq). */
+    size_t seq;
+    secp256k1_scalar blind[2];
+    secp256k1_gej initial[2];
 } secp256k1_ecmult_gen_context;
 
 static void secp256k1_ecmult_gen_context_init(secp256k1_ecmult_gen_context* ctx);
@@ -38,6 +82,9 @@ static int secp256k1_ecmult_gen_context_is_built(const secp256k1_ecmult_gen_cont
 /** Multiply with the generator: R = a*G */
 static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context* ctx, secp256k1_gej *r, const secp256k1_scalar *a);
 
+/** Replace the blinding values. Safe to call concurrently with secp256k1_ecmult_gen and
+ *  itself when atomic builtins are available; multiplications keep using the previous values
+ *  until the new ones are published. */
 static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const unsigned char *seed32);
 
 #endif /* SECP256K1_ECMULT_GEN_H */
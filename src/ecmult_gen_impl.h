@@ -16,77 +16,87 @@
 #endif
 static void secp256k1_ecmult_gen_context_init(secp256k1_ecmult_gen_context *ctx) {
     ctx->prec = NULL;
+    ctx->refcount = NULL;
+    ctx->seq = 0;
+}
+
+/* Copy a consistent pair of blinding values, without waiting for a replacement in progress. */
+static void secp256k1_ecmult_gen_load_blinding(const secp256k1_ecmult_gen_context *ctx, secp256k1_scalar *blind, secp256k1_gej *initial) {
+    size_t seq;
+    int slot;
+    do {
+        seq = secp256k1_seqlock_read_begin(&ctx->seq);
+        slot = secp256k1_seqlock_slot(seq);
+        *blind = ctx->blind[slot];
+        *initial = ctx->initial[slot];
+    } while (secp256k1_seqlock_read_retry(&ctx->seq, seq));
 }
 
 static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context *ctx, const secp256k1_callback* cb) {
 #ifndef USE_ECMULT_STATIC_PRECOMPUTATION
-    secp256k1_ge prec[1024];
-    secp256k1_gej gj;
-    secp256k1_gej nums_gej;
-    int i, j;
+    secp256k1_ge *prec;
+    secp256k1_gej *precj;
+    secp256k1_gej u;
+    secp256k1_gej twou[COMB_TEETH];
+    secp256k1_scalar two, half;
+    int block, tooth, i, j;
 #endif
 
     if (ctx->prec != NULL) {
         return;
     }
 #ifndef USE_ECMULT_STATIC_PRECOMPUTATION
-    ctx->prec = (secp256k1_ge_storage (*)[64][16])checked_malloc(cb, sizeof(*ctx->prec));
-
-    /* get the generator */
-    secp256k1_gej_set_ge(&gj, &secp256k1_ge_const_g);
+    ctx->prec = (secp256k1_ge_storage (*)[COMB_BLOCKS][COMB_POINTS])checked_malloc(cb, sizeof(*ctx->prec));
+    prec = (secp256k1_ge*)checked_malloc(cb, sizeof(secp256k1_ge) * COMB_BLOCKS * COMB_POINTS);
+    precj = (secp256k1_gej*)checked_malloc(cb, sizeof(secp256k1_gej) * COMB_BLOCKS * COMB_POINTS);
 
-    /* Construct a group element with no known corresponding scalar (nothing up my sleeve). */
-    {
-        static const unsigned char nums_b32[33] = "The scalar for this x is unknown";
-        secp256k1_fe nums_x;
-        secp256k1_ge nums_ge;
-        int r;
-        r = secp256k1_fe_set_b32(&nums_x, nums_b32);
-        (void)r;
-        VERIFY_CHECK(r);
-        r = secp256k1_ge_set_xo_var(&nums_ge, &nums_x, 0);
-        (void)r;
-        VERIFY_CHECK(r);
-        secp256k1_gej_set_ge(&nums_gej, &nums_ge);
-        /* Add G to make the bits in x uniformly distributed. */
-        secp256k1_gej_add_ge_var(&nums_gej, &nums_gej, &secp256k1_ge_const_g, NULL);
+    /* Compute H = G/2 by double-and-add with the inverse of 2. */
+    secp256k1_scalar_set_int(&two, 2);
+    secp256k1_scalar_inverse_var(&half, &two);
+    secp256k1_gej_set_infinity(&u);
+    for (i = 255; i >= 0; i--) {
+        secp256k1_gej_double_var(&u, &u, NULL);
+        if (secp256k1_scalar_get_bits_var(&half, i, 1)) {
+            secp256k1_gej_add_ge_var(&u, &u, &secp256k1_ge_const_g, NULL);
+        }
     }
 
-    /* compute prec. */
-    {
-        secp256k1_gej precj[1024]; /* Jacobian versions of prec. */
-        secp256k1_gej gbase;
-        secp256k1_gej numsbase;
-        gbase = gj; /* 16^j * G */
-        numsbase = nums_gej; /* 2^j * nums. */
-        for (j = 0; j < 64; j++) {
-            /* Set precj[j*16 .. j*16+15] to (numsbase, numsbase + gbase, ..., numsbase + 15*gbase). */
-            precj[j*16] = numsbase;
-            for (i = 1; i < 16; i++) {
-                secp256k1_gej_add_var(&precj[j*16 + i], &precj[j*16 + i - 1], &gbase, NULL);
-            }
-            /* Multiply gbase by 16. */
-            for (i = 0; i < 4; i++) {
-                secp256k1_gej_double_var(&gbase, &gbase, NULL);
+    /* compute prec. u runs through 2^(t*COMB_SPACING) * H for all teeth t of all blocks. */
+    for (block = 0; block < COMB_BLOCKS; block++) {
+        secp256k1_gej *blockj = &precj[block * COMB_POINTS];
+        secp256k1_gej neg;
+        secp256k1_gej_set_infinity(&blockj[0]);
+        for (tooth = 0; tooth < COMB_TEETH; tooth++) {
+            if (tooth < COMB_TEETH - 1) {
+                /* All lower teeth negative in the first entry. */
+                secp256k1_gej_neg(&neg, &u);
+                secp256k1_gej_add_var(&blockj[0], &blockj[0], &neg, NULL);
+                secp256k1_gej_double_var(&twou[tooth], &u, NULL);
+            } else {
+                secp256k1_gej_add_var(&blockj[0], &blockj[0], &u, NULL);
             }
-            /* Multiply numbase by 2. */
-            secp256k1_gej_double_var(&numsbase, &numsbase, NULL);
-            if (j == 62) {
-                /* In the last iteration, numsbase is (1 - 2^j) * nums instead. */
-                secp256k1_gej_neg(&numsbase, &numsbase);
-                secp256k1_gej_add_var(&numsbase, &numsbase, &nums_gej, NULL);
+            for (i = 0; i < COMB_SPACING; i++) {
+                secp256k1_gej_double_var(&u, &u, NULL);
             }
         }
-        secp256k1_ge_set_all_gej_var(prec, precj, 1024, cb);
+        for (j = 1; j < COMB_POINTS; j++) {
+            /* Entry j is entry j with its lowest set bit cleared, with that tooth made positive. */
+            for (tooth = 0; !((j >> tooth) & 1); tooth++);
+            secp256k1_gej_add_var(&blockj[j], &blockj[j & (j - 1)], &twou[tooth], NULL);
+        }
     }
-    for (j = 0; j < 64; j++) {
-        for (i = 0; i < 16; i++) {
-            secp256k1_ge_to_storage(&(*ctx->prec)[j][i], &prec[j*16 + i]);
+    secp256k1_ge_set_all_gej_var(prec, precj, COMB_BLOCKS * COMB_POINTS, cb);
+    for (block = 0; block < COMB_BLOCKS; block++) {
+        for (j = 0; j < COMB_POINTS; j++) {
+            secp256k1_ge_to_storage(&(*ctx->prec)[block][j], &prec[block * COMB_POINTS + j]);
         }
     }
+    free(precj);
+    free(prec);
+    ctx->refcount = secp256k1_refcount_create(cb);
 #else
     (void)cb;
-    ctx->prec = (secp256k1_ge_storage (*)[64][16])secp256k1_ecmult_static_context;
+    ctx->prec = (secp256k1_ge_storage (*)[COMB_BLOCKS][COMB_POINTS])secp256k1_ecmult_static_context;
 #endif
     secp256k1_ecmult_gen_blind(ctx, NULL);
 }
@@ -97,81 +107,158 @@ static int secp256k1_ecmult_gen_context_is_built(const secp256k1_ecmult_gen_cont
 
 static void secp256k1_ecmult_gen_context_clone(secp256k1_ecmult_gen_context *dst,
                                                const secp256k1_ecmult_gen_context *src, const secp256k1_callback* cb) {
+    dst->seq = 0;
     if (src->prec == NULL) {
         dst->prec = NULL;
+        dst->refcount = NULL;
     } else {
-#ifndef USE_ECMULT_STATIC_PRECOMPUTATION
-        dst->prec = (secp256k1_ge_storage (*)[64][16])checked_malloc(cb, sizeof(*dst->prec));
-        memcpy(dst->prec, src->prec, sizeof(*dst->prec));
-#else
-        (void)cb;
-        dst->prec = src->prec;
-#endif
-        dst->initial = src->initial;
-        dst->blind = src->blind;
+        /* Only the blinding is copied; the table is static or shared when possible. */
+        if (src->refcount == NULL || secp256k1_refcount_share(src->refcount)) {
+            dst->prec = src->prec;
+            dst->refcount = src->refcount;
+        } else {
+            dst->prec = (secp256k1_ge_storage (*)[COMB_BLOCKS][COMB_POINTS])checked_malloc(cb, sizeof(*dst->prec));
+            memcpy(dst->prec, src->prec, sizeof(*dst->prec));
+            dst->refcount = secp256k1_refcount_create(cb);
+        }
+        secp256k1_ecmult_gen_load_blinding(src, &dst->blind[0], &dst->initial[0]);
     }
 }
 
 static void secp256k1_ecmult_gen_context_clear(secp256k1_ecmult_gen_context *ctx) {
-#ifndef USE_ECMULT_STATIC_PRECOMPUTATION
-    free(ctx->prec);
-#endif
-    secp256k1_scalar_clear(&ctx->blind);
-    secp256k1_gej_clear(&ctx->initial);
+    if (ctx->refcount != NULL && secp256k1_refcount_release(ctx->refcount)) {
+        free(ctx->prec);
+    }
+    secp256k1_scalar_clear(&ctx->blind[0]);
+    secp256k1_scalar_clear(&ctx->blind[1]);
+    secp256k1_gej_clear(&ctx->initial[0]);
+    secp256k1_gej_clear(&ctx->initial[1]);
     ctx->prec = NULL;
+    ctx->refcount = NULL;
 }
 
-static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context *ctx, secp256k1_gej *r, const secp256k1_scalar *gn) {
+/* Compute gn*G given the blinding values blind and initial, where initial doubled
+ * COMB_SPACING - 1 times is (offset - blind)*G (see secp256k1_ecmult_gen_comb_scalars). */
+static void secp256k1_ecmult_gen_blinded(const secp256k1_ecmult_gen_context *ctx, secp256k1_gej *r, const secp256k1_scalar *gn,
+                                         const secp256k1_scalar *blind, const secp256k1_gej *initial) {
     secp256k1_ge add;
     secp256k1_ge_storage adds;
+    secp256k1_fe neg;
     secp256k1_scalar gnb;
-    int bits;
-    int i, j;
+    uint32_t bits, sign;
+    int block, tooth, comb_off, bit_pos;
+    int i;
     memset(&adds, 0, sizeof(adds));
-    *r = ctx->initial;
+    *r = *initial;
     /* Blind scalar/point multiplication by computing (n-b)G + bG instead of nG. */
-    secp256k1_scalar_add(&gnb, gn, &ctx->blind);
+    secp256k1_scalar_add(&gnb, gn, blind);
     add.infinity = 0;
-    for (j = 0; j < 64; j++) {
-        bits = secp256k1_scalar_get_bits(&gnb, j * 4, 4);
-        for (i = 0; i < 16; i++) {
-            /** This uses a conditional move to avoid any secret data in array indexes.
-             *   _Any_ use of secret indexes has been demonstrated to result in timing
-             *   sidechannels, even when the cache-line access patterns are uniform.
-             *  See also:
-             *   "A word of warning", CHES 2013 Rump Session, by Daniel J. Bernstein and Peter Schwabe
-             *    (https://cryptojedi.org/peter/data/chesrump-20130822.pdf) and
-             *   "Cache Attacks and Countermeasures: the Case of AES", RSA 2006,
-             *    by Dag Arne Osvik, Adi Shamir, and Eran Tromer
-             *    (http://www.tau.ac.il/~tromer/papers/cache.pdf)
-             */
-            secp256k1_ge_storage_cmov(&adds, &(*ctx->prec)[j][i], i == bits);
+    for (comb_off = COMB_SPACING - 1; ; comb_off--) {
+        for (block = 0; block < COMB_BLOCKS; block++) {
+            bits = 0;
+            bit_pos = block * COMB_TEETH * COMB_SPACING + comb_off;
+            for (tooth = 0; tooth < COMB_TEETH && bit_pos < COMB_RANGE; tooth++) {
+                bits |= secp256k1_scalar_get_bits(&gnb, bit_pos, 1) << tooth;
+                bit_pos += COMB_SPACING;
+            }
+            /* If the top tooth is negative, use the negation of the entry with all teeth flipped. */
+            sign = (bits >> (COMB_TEETH - 1)) & 1;
+            bits = (bits ^ (sign - 1)) & (COMB_POINTS - 1);
+            for (i = 0; i < COMB_POINTS; i++) {
+                /** This uses a conditional move to avoid any secret data in array indexes.
+                 *   _Any_ use of secret indexes has been demonstrated to result in timing
+                 *   sidechannels, even when the cache-line access patterns are uniform.
+                 *  See also:
+                 *   "A word of warning", CHES 2013 Rump Session, by Daniel J. Bernstein and Peter Schwabe
+                 *    (https://cryptojedi.org/peter/data/chesrump-20130822.pdf) and
+                 *   "Cache Attacks and Countermeasures: the Case of AES", RSA 2006,
+                 *    by Dag Arne Osvik, Adi Shamir, and Eran Tromer
+                 *    (http://www.tau.ac.il/~tromer/papers/cache.pdf)
+                 */
+                secp256k1_ge_storage_cmov(&adds, &(*ctx->prec)[block][i], (uint32_t)i == bits);
+            }
+            secp256k1_ge_from_storage(&add, &adds);
+            secp256k1_fe_negate(&neg, &add.y, 1);
+            secp256k1_fe_cmov(&add.y, &neg, sign ^ 1);
+            secp256k1_gej_add_ge(r, r, &add);
         }
-        secp256k1_ge_from_storage(&add, &adds);
-        secp256k1_gej_add_ge(r, r, &add);
+        if (comb_off == 0) {
+            break;
+        }
+        /* Only branches on infinity, which the blinding makes cryptographically unlikely. */
+        secp256k1_gej_double_var(r, r, NULL);
     }
     bits = 0;
+    sign = 0;
     secp256k1_ge_clear(&add);
+    secp256k1_fe_clear(&neg);
     secp256k1_scalar_clear(&gnb);
 }
 
-/* Setup blinding values for secp256k1_ecmult_gen. */
+/* Compute the scalars relating the blinding values: the comb of d is (d - offset)*G, and
+ * the initial point gets doubled COMB_SPACING - 1 times, which scale undoes. */
+static void secp256k1_ecmult_gen_comb_scalars(secp256k1_scalar *offset, secp256k1_scalar *scale) {
+    secp256k1_scalar one, two, half;
+    int i;
+    secp256k1_scalar_set_int(&one, 1);
+    secp256k1_scalar_set_int(&two, 2);
+    secp256k1_scalar_inverse_var(&half, &two);
+    /* offset = (2^COMB_BITS - 1) / 2 */
+    *offset = one;
+    for (i = 0; i < COMB_BITS; i++) {
+        secp256k1_scalar_add(offset, offset, offset);
+    }
+    secp256k1_scalar_negate(&one, &one);
+    secp256k1_scalar_add(offset, offset, &one);
+    secp256k1_scalar_mul(offset, offset, &half);
+    /* scale = 2^-(COMB_SPACING - 1) */
+    secp256k1_scalar_set_int(scale, 1);
+    for (i = 1; i < COMB_SPACING; i++) {
+        secp256k1_scalar_mul(scale, scale, &half);
+    }
+}
+
+static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context *ctx, secp256k1_gej *r, const secp256k1_scalar *gn) {
+    secp256k1_scalar blind;
+    secp256k1_gej initial;
+    secp256k1_ecmult_gen_load_blinding(ctx, &blind, &initial);
+    secp256k1_ecmult_gen_blinded(ctx, r, gn, &blind, &initial);
+    secp256k1_scalar_clear(&blind);
+    secp256k1_gej_clear(&initial);
+}
+
+/* Setup blinding values for secp256k1_ecmult_gen. The new values are computed from a copy
+ * of the old ones and published at once, so concurrent multiplications see either. */
 static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const unsigned char *seed32) {
     secp256k1_scalar b;
     secp256k1_gej gb;
+    secp256k1_scalar blind;
+    secp256k1_gej initial;
+    secp256k1_scalar offset, scale;
     secp256k1_fe s;
     unsigned char nonce32[32];
     secp256k1_rfc6979_hmac_sha256 rng;
-    int retry;
+    int retry, slot;
     unsigned char keydata[64] = {0};
+    secp256k1_ecmult_gen_comb_scalars(&offset, &scale);
     if (seed32 == NULL) {
-        /* When seed is NULL, reset the initial point and blinding value. */
-        secp256k1_gej_set_ge(&ctx->initial, &secp256k1_ge_const_g);
-        secp256k1_gej_neg(&ctx->initial, &ctx->initial);
-        secp256k1_scalar_set_int(&ctx->blind, 1);
+        /* When seed is NULL, reset the initial point and blinding value. The initial point is
+         * (offset - 1)*scale*G, computed without blinding as it is public. */
+        secp256k1_scalar_set_int(&blind, 1);
+        secp256k1_scalar_negate(&b, &blind);
+        secp256k1_scalar_add(&b, &b, &offset);
+        secp256k1_scalar_mul(&b, &b, &scale);
+        secp256k1_scalar_add(&b, &b, &offset);
+        secp256k1_scalar_set_int(&blind, 0);
+        secp256k1_gej_set_infinity(&initial);
+        secp256k1_ecmult_gen_blinded(ctx, &gb, &b, &blind, &initial);
+        initial = gb;
+        secp256k1_scalar_set_int(&blind, 1);
+    } else {
+        secp256k1_ecmult_gen_load_blinding(ctx, &blind, &initial);
     }
     /* The prior blinding value (if not reset) is chained forward by including it in the hash. */
-    secp256k1_scalar_get_b32(nonce32, &ctx->blind);
+    secp256k1_scalar_get_b32(nonce32, &blind);
     /** Using a CSPRNG allows a failure free interface, avoids needing large amounts of random data,
      *   and guards against weak or adversarial seeds.  This is a simpler and safer interface than
      *   asking the caller for blinding values directly and expecting them to retry on failure.
@@ -189,7 +276,7 @@ static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const
         retry |= secp256k1_fe_is_zero(&s);
     } while (retry); /* This branch true is cryptographically unreachable. Requires sha256_hmac output > Fp. */
     /* Randomize the projection to defend against multiplier sidechannels. */
-    secp256k1_gej_rescale(&ctx->initial, &s);
+    secp256k1_gej_rescale(&initial, &s);
     secp256k1_fe_clear(&s);
     do {
         secp256k1_rfc6979_hmac_sha256_generate(&rng, nonce32, 32);
@@ -199,12 +286,20 @@ static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const
     } while (retry); /* This branch true is cryptographically unreachable. Requires sha256_hmac output > order. */
     secp256k1_rfc6979_hmac_sha256_finalize(&rng);
     memset(nonce32, 0, 32);
-    secp256k1_ecmult_gen(ctx, &gb, &b);
+    /* The new initial point is (offset + b)*scale*G, for the blinding value -b. */
+    secp256k1_scalar_add(&offset, &offset, &b);
+    secp256k1_scalar_mul(&offset, &offset, &scale);
+    secp256k1_ecmult_gen_blinded(ctx, &gb, &offset, &blind, &initial);
+    secp256k1_scalar_clear(&offset);
     secp256k1_scalar_negate(&b, &b);
-    ctx->blind = b;
-    ctx->initial = gb;
+    slot = secp256k1_seqlock_write_begin(&ctx->seq);
+    ctx->blind[slot] = b;
+    ctx->initial[slot] = gb;
+    secp256k1_seqlock_write_end(&ctx->seq);
     secp256k1_scalar_clear(&b);
     secp256k1_gej_clear(&gb);
+    secp256k1_scalar_clear(&blind);
+    secp256k1_gej_clear(&initial);
 }
 
 #endif /* SECP256K1_ECMULT_GEN_IMPL_H */
@@ -21,16 +21,23 @@
 #  if EXHAUSTIVE_TEST_ORDER > 128
 #    define WINDOW_A 5
 #    define WINDOW_G 8
+#    define WINDOW_P 8
 #  elif EXHAUSTIVE_TEST_ORDER > 8
 #    define WINDOW_A 4
 #    define WINDOW_G 4
+#    define WINDOW_P 4
 #  else
 #    define WINDOW_A 2
 #    define WINDOW_G 2
+#    define WINDOW_P 2
 #  endif
 #else
 /* optimal for 128-bit and 256-bit exponents. */
 #define WINDOW_A 5
+/** Window size for the precomputed tables of secp256k1_ecmult_point_table. These are built
+ *  once per point, so they can be wider than WINDOW_A; 8 keeps them within 4 KiB (8 KiB
+ *  with the endomorphism) so that they stay in L1 cache. */
+#define WINDOW_P 8
 /** larger numbers may result in slightly better performance, at the cost of
     exponentially larger precomputed tables. */
 #ifdef USE_ENDOMORPHISM
@@ -42,6 +49,16 @@
 #endif
 #endif
 
+/** The range of generator window sizes a verification context can be built with
+ *  (WINDOW_G is the default). Each step up doubles the size of the tables. */
+#define WINDOW_G_MIN 2
+#if defined(EXHAUSTIVE_TEST_ORDER)
+#define WINDOW_G_MAX WINDOW_G
+#else
+/** Two tables for window size 24: 512 MiB. */
+#define WINDOW_G_MAX 24
+#endif
+
 #ifdef USE_ENDOMORPHISM
     #define WNAF_BITS 128
 #else
@@ -53,11 +70,19 @@
 /** The number of entries a table with precomputed multiples needs to have. */
 #define ECMULT_TABLE_SIZE(w) (1 << ((w)-2))
 
+#ifdef USE_ECMULT_STATIC_PRECOMPUTATION
+#include "ecmult_static_pre_g.h"
+#endif
+
 /* The number of objects allocated on the scratch space for ecmult_multi algorithms */
-#define PIPPENGER_SCRATCH_OBJECTS 6
+#define PIPPENGER_SCRATCH_OBJECTS 8
 #define STRAUSS_SCRATCH_OBJECTS 6
 
 #define PIPPENGER_MAX_BUCKET_WINDOW 12
+/* From this bucket window on, Pippenger accumulates the buckets in affine
+ * coordinates. Smaller windows have too few points per bucket to make up for
+ * the field inversions of the additional rounds. */
+#define PIPPENGER_AFFINE_MIN_BUCKET_WINDOW 7
 
 /* Minimum number of points for which pippenger_wnaf is faster than strauss wnaf */
 #ifdef USE_ENDOMORPHISM
@@ -187,58 +212,74 @@ static void secp256k1_ecmult_context_init(secp256k1_ecmult_context *ctx) {
 #ifdef USE_ENDOMORPHISM
     ctx->pre_g_128 = NULL;
 #endif
+    ctx->window_g = 0;
+    ctx->refcount = NULL;
 }
 
-static void secp256k1_ecmult_context_build(secp256k1_ecmult_context *ctx, const secp256k1_callback *cb) {
+static void secp256k1_ecmult_context_build(secp256k1_ecmult_context *ctx, int window_g, const secp256k1_callback *cb) {
     secp256k1_gej gj;
 
+    VERIFY_CHECK(window_g >= WINDOW_G_MIN && window_g <= WINDOW_G_MAX);
     if (ctx->pre_g != NULL) {
         return;
     }
+    ctx->window_g = window_g;
+
+#ifdef USE_ECMULT_STATIC_PRECOMPUTATION
+    if (window_g == WINDOW_G) {
+        (void)cb;
+        ctx->pre_g = (secp256k1_ge_storage (*)[])secp256k1_ecmult_static_pre_g;
+#ifdef USE_ENDOMORPHISM
+        ctx->pre_g_128 = (secp256k1_ge_storage (*)[])secp256k1_ecmult_static_pre_g_128;
+#endif
+        return;
+    }
+#endif
 
     /* get the generator */
     secp256k1_gej_set_ge(&gj, &secp256k1_ge_const_g);
 
-    ctx->pre_g = (secp256k1_ge_storage (*)[])checked_malloc(cb, sizeof((*ctx->pre_g)[0]) * ECMULT_TABLE_SIZE(WINDOW_G));
+    ctx->pre_g = (secp256k1_ge_storage (*)[])checked_malloc(cb, sizeof((*ctx->pre_g)[0]) * ECMULT_TABLE_SIZE(window_g));
 
     /* precompute the tables with odd multiples */
-    secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(WINDOW_G), *ctx->pre_g, &gj, cb);
+    secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(window_g), *ctx->pre_g, &gj, cb);
+    ctx->refcount = secp256k1_refcount_create(cb);
 
 #ifdef USE_ENDOMORPHISM
     {
         secp256k1_gej g_128j;
         int i;
 
-        ctx->pre_g_128 = (secp256k1_ge_storage (*)[])checked_malloc(cb, sizeof((*ctx->pre_g_128)[0]) * ECMULT_TABLE_SIZE(WINDOW_G));
+        ctx->pre_g_128 = (secp256k1_ge_storage (*)[])checked_malloc(cb, sizeof((*ctx->pre_g_128)[0]) * ECMULT_TABLE_SIZE(window_g));
 
         /* calculate 2^128*generator */
         g_128j = gj;
         for (i = 0; i < 128; i++) {
             secp256k1_gej_double_var(&g_128j, &g_128j, NULL);
         }
-        secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(WINDOW_G), *ctx->pre_g_128, &g_128j, cb);
+        secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(window_g), *ctx->pre_g_128, &g_128j, cb);
     }
 #endif
 }
 
 static void secp256k1_ecmult_context_clone(secp256k1_ecmult_context *dst,
                                            const secp256k1_ecmult_context *src, const secp256k1_callback *cb) {
-    if (src->pre_g == NULL) {
-        dst->pre_g = NULL;
-    } else {
-        size_t size = sizeof((*dst->pre_g)[0]) * ECMULT_TABLE_SIZE(WINDOW_G);
+    /* Static tables are never freed and owned ones are shared when possible. */
+    if (src->refcount == NULL || secp256k1_refcount_share(src->refcount)) {
+        *dst = *src;
+        return;
+    }
+    {
+        size_t size = sizeof((*dst->pre_g)[0]) * ECMULT_TABLE_SIZE(src->window_g);
         dst->pre_g = (secp256k1_ge_storage (*)[])checked_malloc(cb, size);
         memcpy(dst->pre_g, src->pre_g, size);
-    }
 #ifdef USE_ENDOMORPHISM
-    if (src->pre_g_128 == NULL) {
-        dst->pre_g_128 = NULL;
-    } else {
-        size_t size = sizeof((*dst->pre_g_128)[0]) * ECMULT_TABLE_SIZE(WINDOW_G);
         dst->pre_g_128 = (secp256k1_ge_storage (*)[])checked_malloc(cb, size);
         memcpy(dst->pre_g_128, src->pre_g_128, size);
-    }
 #endif
+    }
+    dst->window_g = src->window_g;
+    dst->refcount = secp256k1_refcount_create(cb);
 }
 
 static int secp256k1_ecmult_context_is_built(const secp256k1_ecmult_context *ctx) {
@@ -246,10 +287,12 @@ static int secp256k1_ecmult_context_is_built(const secp256k1_ecmult_context *ctx
 }
 
 static void secp256k1_ecmult_context_clear(secp256k1_ecmult_context *ctx) {
-    free(ctx->pre_g);
+    if (ctx->refcount != NULL && secp256k1_refcount_release(ctx->refcount)) {
+        free(ctx->pre_g);
 #ifdef USE_ENDOMORPHISM
-    free(ctx->pre_g_128);
+        free(ctx->pre_g_128);
 #endif
+    }
     secp256k1_ecmult_context_init(ctx);
 }
 
@@ -424,8 +467,8 @@ static void secp256k1_ecmult_strauss_wnaf(const secp256k1_ecmult_context *ctx, c
         secp256k1_scalar_split_128(&ng_1, &ng_128, ng);
 
         /* Build wnaf representation for ng_1 and ng_128 */
-        bits_ng_1   = secp256k1_ecmult_wnaf(wnaf_ng_1,   129, &ng_1,   WINDOW_G);
-        bits_ng_128 = secp256k1_ecmult_wnaf(wnaf_ng_128, 129, &ng_128, WINDOW_G);
+        bits_ng_1   = secp256k1_ecmult_wnaf(wnaf_ng_1,   129, &ng_1,   ctx->window_g);
+        bits_ng_128 = secp256k1_ecmult_wnaf(wnaf_ng_128, 129, &ng_128, ctx->window_g);
         if (bits_ng_1 > bits) {
             bits = bits_ng_1;
         }
@@ -435,7 +478,7 @@ static void secp256k1_ecmult_strauss_wnaf(const secp256k1_ecmult_context *ctx, c
     }
 #else
     if (ng) {
-        bits_ng     = secp256k1_ecmult_wnaf(wnaf_ng,     256, ng,      WINDOW_G);
+        bits_ng     = secp256k1_ecmult_wnaf(wnaf_ng,     256, ng,      ctx->window_g);
         if (bits_ng > bits) {
             bits = bits_ng;
         }
@@ -459,11 +502,11 @@ static void secp256k1_ecmult_strauss_wnaf(const secp256k1_ecmult_context *ctx, c
             }
         }
         if (i < bits_ng_1 && (n = wnaf_ng_1[i])) {
-            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, WINDOW_G);
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, ctx->window_g);
             secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
         }
         if (i < bits_ng_128 && (n = wnaf_ng_128[i])) {
-            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g_128, n, WINDOW_G);
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g_128, n, ctx->window_g);
             secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
         }
 #else
@@ -474,7 +517,7 @@ static void secp256k1_ecmult_strauss_wnaf(const secp256k1_ecmult_context *ctx, c
             }
         }
         if (i < bits_ng && (n = wnaf_ng[i])) {
-            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, WINDOW_G);
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, ctx->window_g);
             secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
         }
 #endif
@@ -505,6 +548,143 @@ static void secp256k1_ecmult(const secp256k1_ecmult_context *ctx, secp256k1_gej
     secp256k1_ecmult_strauss_wnaf(ctx, &state, r, 1, a, na, ng);
 }
 
+static void secp256k1_ecmult_g_var(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_scalar *ng) {
+    /* Without points, no odd multiples table is built and the state is unused. */
+    struct secp256k1_strauss_state state;
+    memset(&state, 0, sizeof(state));
+    secp256k1_ecmult_strauss_wnaf(ctx, &state, r, 0, NULL, NULL, ng);
+}
+
+static void secp256k1_ecmult_point_table_init(secp256k1_ecmult_point_table *tbl) {
+    tbl->pre_a = NULL;
+#ifdef USE_ENDOMORPHISM
+    tbl->pre_a_lam = NULL;
+#endif
+}
+
+static void secp256k1_ecmult_point_table_build(secp256k1_ecmult_point_table *tbl, const secp256k1_ge *a, const secp256k1_callback *cb) {
+    secp256k1_gej aj;
+
+    VERIFY_CHECK(!secp256k1_ge_is_infinity(a));
+    secp256k1_gej_set_ge(&aj, a);
+
+    tbl->pre_a = (secp256k1_ge_storage (*)[])checked_malloc(cb, sizeof((*tbl->pre_a)[0]) * ECMULT_TABLE_SIZE(WINDOW_P));
+    secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(WINDOW_P), *tbl->pre_a, &aj, cb);
+
+#ifdef USE_ENDOMORPHISM
+    {
+        secp256k1_ge tmp;
+        int i;
+
+        tbl->pre_a_lam = (secp256k1_ge_storage (*)[])checked_malloc(cb, sizeof((*tbl->pre_a_lam)[0]) * ECMULT_TABLE_SIZE(WINDOW_P));
+        for (i = 0; i < ECMULT_TABLE_SIZE(WINDOW_P); i++) {
+            secp256k1_ge_from_storage(&tmp, &(*tbl->pre_a)[i]);
+            secp256k1_ge_mul_lambda(&tmp, &tmp);
+            secp256k1_ge_to_storage(&(*tbl->pre_a_lam)[i], &tmp);
+        }
+    }
+#endif
+}
+
+static void secp256k1_ecmult_point_table_clear(secp256k1_ecmult_point_table *tbl) {
+    free(tbl->pre_a);
+#ifdef USE_ENDOMORPHISM
+    free(tbl->pre_a_lam);
+#endif
+    secp256k1_ecmult_point_table_init(tbl);
+}
+
+static void secp256k1_ecmult_with_table(const secp256k1_ecmult_context *ctx, const secp256k1_ecmult_point_table *tbl, secp256k1_gej *r, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
+    secp256k1_ge tmpa;
+#ifdef USE_ENDOMORPHISM
+    secp256k1_scalar na_1, na_lam, ng_1, ng_128;
+    int wnaf_na_1[130];
+    int wnaf_na_lam[130];
+    int bits_na_1 = 0;
+    int bits_na_lam = 0;
+    int wnaf_ng_1[129];
+    int bits_ng_1 = 0;
+    int wnaf_ng_128[129];
+    int bits_ng_128 = 0;
+#else
+    int wnaf_na[256];
+    int bits_na = 0;
+    int wnaf_ng[256];
+    int bits_ng = 0;
+#endif
+    int i;
+    int bits = 0;
+
+    /* Both the table of A and the tables of G are affine, so unlike in
+     * secp256k1_ecmult_strauss_wnaf no Z correction is needed. */
+#ifdef USE_ENDOMORPHISM
+    if (na) {
+        secp256k1_scalar_split_lambda(&na_1, &na_lam, na);
+        bits_na_1   = secp256k1_ecmult_wnaf(wnaf_na_1,   130, &na_1,   WINDOW_P);
+        bits_na_lam = secp256k1_ecmult_wnaf(wnaf_na_lam, 130, &na_lam, WINDOW_P);
+        VERIFY_CHECK(bits_na_1 <= 130);
+        VERIFY_CHECK(bits_na_lam <= 130);
+        bits = bits_na_1 > bits_na_lam ? bits_na_1 : bits_na_lam;
+    }
+    if (ng) {
+        secp256k1_scalar_split_128(&ng_1, &ng_128, ng);
+        bits_ng_1   = secp256k1_ecmult_wnaf(wnaf_ng_1,   129, &ng_1,   ctx->window_g);
+        bits_ng_128 = secp256k1_ecmult_wnaf(wnaf_ng_128, 129, &ng_128, ctx->window_g);
+        if (bits_ng_1 > bits) {
+            bits = bits_ng_1;
+        }
+        if (bits_ng_128 > bits) {
+            bits = bits_ng_128;
+        }
+    }
+#else
+    if (na) {
+        bits_na = secp256k1_ecmult_wnaf(wnaf_na, 256, na, WINDOW_P);
+        bits = bits_na;
+    }
+    if (ng) {
+        bits_ng = secp256k1_ecmult_wnaf(wnaf_ng, 256, ng, ctx->window_g);
+        if (bits_ng > bits) {
+            bits = bits_ng;
+        }
+    }
+#endif
+
+    secp256k1_gej_set_infinity(r);
+
+    for (i = bits - 1; i >= 0; i--) {
+        int n;
+        secp256k1_gej_double_var(r, r, NULL);
+#ifdef USE_ENDOMORPHISM
+        if (i < bits_na_1 && (n = wnaf_na_1[i])) {
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *tbl->pre_a, n, WINDOW_P);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+        if (i < bits_na_lam && (n = wnaf_na_lam[i])) {
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *tbl->pre_a_lam, n, WINDOW_P);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+        if (i < bits_ng_1 && (n = wnaf_ng_1[i])) {
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, ctx->window_g);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+        if (i < bits_ng_128 && (n = wnaf_ng_128[i])) {
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g_128, n, ctx->window_g);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+#else
+        if (i < bits_na && (n = wnaf_na[i])) {
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *tbl->pre_a, n, WINDOW_P);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+        if (i < bits_ng && (n = wnaf_ng[i])) {
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, ctx->window_g);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+#endif
+    }
+}
+
 static size_t secp256k1_strauss_scratch_size(size_t n_points) {
 #ifdef USE_ENDOMORPHISM
     static const size_t point_size = (2 * sizeof(secp256k1_ge) + sizeof(secp256k1_gej) + sizeof(secp256k1_fe)) * ECMULT_TABLE_SIZE(WINDOW_A) + sizeof(struct secp256k1_strauss_point_state) + sizeof(secp256k1_gej) + sizeof(secp256k1_scalar);
@@ -641,37 +821,192 @@ struct secp256k1_pippenger_state {
     struct secp256k1_pippenger_point_state* ps;
 };
 
+/* Workspace for accumulating the buckets of one window in affine coordinates. */
+struct secp256k1_pippenger_affine_state {
+    secp256k1_ge *acc;   /* points sorted by bucket, replaced by their partial sums */
+    secp256k1_fe *den;   /* denominators of a round of additions, followed by their inverses */
+    size_t *start;       /* position of the first entry of every bucket in acc */
+    size_t *len;         /* number of entries of every bucket in acc */
+};
+
+/* Adds two affine points a and b given inv, the inverse of the denominator
+ * of the slope as computed by pippenger_affine_buckets. Returns 0 (and leaves r
+ * untouched) if the sum is infinity. All coordinates have magnitude 1. */
+static int secp256k1_ecmult_pippenger_affine_add(secp256k1_ge *r, const secp256k1_ge *a, const secp256k1_ge *b, const secp256k1_fe *inv) {
+    secp256k1_fe lambda, t;
+
+    if (!secp256k1_fe_equal_var(&a->x, &b->x)) {
+        /* lambda = (b.y - a.y) / (b.x - a.x) */
+        secp256k1_fe_negate(&lambda, &a->y, 1);
+        secp256k1_fe_add(&lambda, &b->y);
+    } else if (secp256k1_fe_equal_var(&a->y, &b->y)) {
+        /* lambda = 3*a.x^2 / (2*a.y) */
+        secp256k1_fe_sqr(&lambda, &a->x);
+        secp256k1_fe_mul_int(&lambda, 3);
+    } else {
+        return 0;
+    }
+    secp256k1_fe_mul(&lambda, &lambda, inv);
+    /* x = lambda^2 - a.x - b.x; y = lambda*(a.x - x) - a.y */
+    secp256k1_fe_sqr(&r->x, &lambda);
+    secp256k1_fe_negate(&t, &a->x, 1);
+    secp256k1_fe_add(&r->x, &t);
+    secp256k1_fe_negate(&t, &b->x, 1);
+    secp256k1_fe_add(&r->x, &t);
+    secp256k1_fe_normalize_weak(&r->x);
+    secp256k1_fe_negate(&t, &r->x, 1);
+    secp256k1_fe_add(&t, &a->x);
+    secp256k1_fe_mul(&r->y, &lambda, &t);
+    secp256k1_fe_negate(&t, &a->y, 1);
+    secp256k1_fe_add(&r->y, &t);
+    secp256k1_fe_normalize_weak(&r->y);
+    r->infinity = 0;
+    return 1;
+}
+
 /*
- * pippenger_wnaf computes the result of a multi-point multiplication as
- * follows: The scalars are brought into wnaf with n_wnaf elements each. Then
- * for every i < n_wnaf, first each point is added to a "bucket" corresponding
- * to the point's wnaf[i]. Second, the buckets are added together such that
- * r += 1*bucket[0] + 3*bucket[1] + 5*bucket[2] + ...
+ * Sorts the points of wnaf window i into their buckets and adds up the
+ * entries of every bucket in affine coordinates. The additions of a round are
+ * independent, so they share a single field inversion. Each round halves the
+ * number of entries per bucket; afterwards bucket j holds len[j] <= 1 entries,
+ * stored at acc[start[j]].
  */
-static int secp256k1_ecmult_pippenger_wnaf(secp256k1_gej *buckets, int bucket_window, struct secp256k1_pippenger_state *state, secp256k1_gej *r, const secp256k1_scalar *sc, const secp256k1_ge *pt, size_t num) {
+static void secp256k1_ecmult_pippenger_affine_buckets(const struct secp256k1_pippenger_affine_state *affine, int bucket_window, const struct secp256k1_pippenger_state *state, const secp256k1_ge *pt, size_t no, int i) {
     size_t n_wnaf = WNAF_SIZE(bucket_window+1);
+    size_t n_buckets = ECMULT_TABLE_SIZE(bucket_window+2);
     size_t np;
-    size_t no = 0;
-    int i;
-    int j;
+    size_t j;
+    size_t pos = 0;
 
-    for (np = 0; np < num; ++np) {
-        if (secp256k1_scalar_is_zero(&sc[np]) || secp256k1_ge_is_infinity(&pt[np])) {
+    for (j = 0; j < n_buckets; j++) {
+        affine->len[j] = 0;
+    }
+    for (np = 0; np < no; np++) {
+        int n = state->wnaf_na[np*n_wnaf + i];
+        if (n != 0) {
+            affine->len[(n > 0 ? n - 1 : -(n + 1))/2]++;
+        }
+    }
+    for (j = 0; j < n_buckets; j++) {
+        affine->start[j] = pos;
+        pos += affine->len[j];
+        affine->len[j] = 0;
+    }
+    for (np = 0; np < no; np++) {
+        int n = state->wnaf_na[np*n_wnaf + i];
+        secp256k1_ge *entry;
+        if (n == 0) {
             continue;
         }
-        state->ps[no].input_pos = np;
-        state->ps[no].skew_na = secp256k1_wnaf_fixed(&state->wnaf_na[no*n_wnaf], &sc[np], bucket_window+1);
-        no++;
+        j = (n > 0 ? n - 1 : -(n + 1))/2;
+        entry = &affine->acc[affine->start[j] + affine->len[j]++];
+        *entry = pt[state->ps[np].input_pos];
+        if (n < 0) {
+            secp256k1_ge_neg(entry, entry);
+        }
+        secp256k1_fe_normalize_weak(&entry->x);
+        secp256k1_fe_normalize_weak(&entry->y);
     }
-    secp256k1_gej_set_infinity(r);
 
-    if (no == 0) {
-        return 1;
+    for (;;) {
+        size_t n_pairs = 0;
+        secp256k1_fe *inv = &affine->den[(pos + 1)/2];
+        for (j = 0; j < n_buckets; j++) {
+            size_t k;
+            for (k = 0; k + 1 < affine->len[j]; k += 2) {
+                const secp256k1_ge *a = &affine->acc[affine->start[j] + k];
+                secp256k1_fe *den = &affine->den[n_pairs++];
+                if (!secp256k1_fe_equal_var(&a[0].x, &a[1].x)) {
+                    secp256k1_fe_negate(den, &a[0].x, 1);
+                    secp256k1_fe_add(den, &a[1].x);
+                } else if (secp256k1_fe_equal_var(&a[0].y, &a[1].y)) {
+                    *den = a[0].y;
+                    secp256k1_fe_mul_int(den, 2);
+                } else {
+                    /* a[1] == -a[0], the sum is infinity */
+                    secp256k1_fe_set_int(den, 1);
+                }
+            }
+        }
+        if (n_pairs == 0) {
+            break;
+        }
+        secp256k1_fe_inv_all_var(inv, affine->den, n_pairs);
+
+        /* Sums are written in place, in front of the entries still to be read. */
+        n_pairs = 0;
+        for (j = 0; j < n_buckets; j++) {
+            secp256k1_ge *bucket = &affine->acc[affine->start[j]];
+            size_t out = 0;
+            size_t k;
+            for (k = 0; k + 1 < affine->len[j]; k += 2) {
+                secp256k1_ge a = bucket[k];
+                secp256k1_ge b = bucket[k + 1];
+                if (secp256k1_ecmult_pippenger_affine_add(&bucket[out], &a, &b, &inv[n_pairs++])) {
+                    out++;
+                }
+            }
+            if (k < affine->len[j]) {
+                bucket[out++] = bucket[k];
+            }
+            affine->len[j] = out;
+        }
     }
+}
+
+/*
+ * pippenger_windows computes the part of a multi-point multiplication
+ * that corresponds to the wnaf windows lo <= i < hi, shifted down by lo
+ * windows: for every such i, first each point is added to a "bucket"
+ * corresponding to the point's wnaf[i]. Second, the buckets are added together
+ * such that r += 1*bucket[0] + 3*bucket[1] + 5*bucket[2] + ...
+ * Different window ranges use independent buckets and can be computed
+ * concurrently.
+ */
+static void secp256k1_ecmult_pippenger_windows(secp256k1_gej *buckets, const struct secp256k1_pippenger_affine_state *affine, int bucket_window, const struct secp256k1_pippenger_state *state, secp256k1_gej *r, const secp256k1_ge *pt, size_t no, int lo, int hi) {
+    size_t n_wnaf = WNAF_SIZE(bucket_window+1);
+    size_t np;
+    int i;
+    int j;
 
-    for (i = n_wnaf - 1; i >= 0; i--) {
+    secp256k1_gej_set_infinity(r);
+    for (i = hi - 1; i >= lo; i--) {
         secp256k1_gej running_sum;
 
+        if (affine != NULL) {
+            /* Same as below, but with the buckets in affine coordinates. */
+            secp256k1_gej bucket0;
+            secp256k1_ecmult_pippenger_affine_buckets(affine, bucket_window, state, pt, no, i);
+            secp256k1_gej_set_infinity(&bucket0);
+            if (affine->len[0] > 0) {
+                secp256k1_gej_set_ge(&bucket0, &affine->acc[affine->start[0]]);
+            }
+            if (i == 0) {
+                /* correct for wnaf skew */
+                for (np = 0; np < no; ++np) {
+                    if (state->ps[np].skew_na) {
+                        secp256k1_ge tmp;
+                        secp256k1_ge_neg(&tmp, &pt[state->ps[np].input_pos]);
+                        secp256k1_gej_add_ge_var(&bucket0, &bucket0, &tmp, NULL);
+                    }
+                }
+            }
+            for(j = 0; j < bucket_window; j++) {
+                secp256k1_gej_double_var(r, r, NULL);
+            }
+            secp256k1_gej_set_infinity(&running_sum);
+            for(j = ECMULT_TABLE_SIZE(bucket_window+2) - 1; j > 0; j--) {
+                if (affine->len[j] > 0) {
+                    secp256k1_gej_add_ge_var(&running_sum, &running_sum, &affine->acc[affine->start[j]], NULL);
+                }
+                secp256k1_gej_add_var(r, r, &running_sum, NULL);
+            }
+            secp256k1_gej_add_var(&running_sum, &running_sum, &bucket0, NULL);
+            secp256k1_gej_double_var(r, r, NULL);
+            secp256k1_gej_add_var(r, r, &running_sum, NULL);
+            continue;
+        }
+
         for(j = 0; j < ECMULT_TABLE_SIZE(bucket_window+2); j++) {
             secp256k1_gej_set_infinity(&buckets[j]);
         }
@@ -722,6 +1057,38 @@ static int secp256k1_ecmult_pippenger_wnaf(secp256k1_gej *buckets, int bucket_wi
         secp256k1_gej_double_var(r, r, NULL);
         secp256k1_gej_add_var(r, r, &running_sum, NULL);
     }
+}
+
+/* Computes the wnaf of every point with a non-zero scalar into state, and returns the number of such points. */
+static size_t secp256k1_ecmult_pippenger_wnaf_init(int bucket_window, struct secp256k1_pippenger_state *state, const secp256k1_scalar *sc, const secp256k1_ge *pt, size_t num) {
+    size_t n_wnaf = WNAF_SIZE(bucket_window+1);
+    size_t np;
+    size_t no = 0;
+
+    for (np = 0; np < num; ++np) {
+        if (secp256k1_scalar_is_zero(&sc[np]) || secp256k1_ge_is_infinity(&pt[np])) {
+            continue;
+        }
+        state->ps[no].input_pos = np;
+        state->ps[no].skew_na = secp256k1_wnaf_fixed(&state->wnaf_na[no*n_wnaf], &sc[np], bucket_window+1);
+        no++;
+    }
+    return no;
+}
+
+/*
+ * pippenger_wnaf computes the result of a multi-point multiplication as
+ * follows: The scalars are brought into wnaf with n_wnaf elements each. Then
+ * all windows are processed with pippenger_windows.
+ */
+static int secp256k1_ecmult_pippenger_wnaf(secp256k1_gej *buckets, const struct secp256k1_pippenger_affine_state *affine, int bucket_window, struct secp256k1_pippenger_state *state, secp256k1_gej *r, const secp256k1_scalar *sc, const secp256k1_ge *pt, size_t num) {
+    size_t no = secp256k1_ecmult_pippenger_wnaf_init(bucket_window, state, sc, pt, num);
+
+    secp256k1_gej_set_infinity(r);
+    if (no == 0) {
+        return 1;
+    }
+    secp256k1_ecmult_pippenger_windows(buckets, affine, bucket_window, state, r, pt, no, 0, WNAF_SIZE(bucket_window+1));
     return 1;
 }
 
@@ -837,6 +1204,22 @@ SECP256K1_INLINE static void secp256k1_ecmult_endo_split(secp256k1_scalar *s1, s
 }
 #endif
 
+/**
+ * Returns the scratch size of the buckets (or, in affine mode, the bucket
+ * workspace) that every concurrently processed range of windows needs.
+ */
+static size_t secp256k1_pippenger_bucket_scratch_size(size_t n_points, int bucket_window) {
+#ifdef USE_ENDOMORPHISM
+    size_t entries = 2*n_points + 2;
+#else
+    size_t entries = n_points + 1;
+#endif
+    if (bucket_window >= PIPPENGER_AFFINE_MIN_BUCKET_WINDOW) {
+        return entries * (sizeof(secp256k1_ge) + sizeof(secp256k1_fe)) + 2 * (1<<bucket_window) * sizeof(size_t);
+    }
+    return (1<<bucket_window) * sizeof(secp256k1_gej);
+}
+
 /**
  * Returns the scratch size required for a given number of points (excluding
  * base point G) without considering alignment.
@@ -848,10 +1231,45 @@ static size_t secp256k1_pippenger_scratch_size(size_t n_points, int bucket_windo
     size_t entries = n_points + 1;
 #endif
     size_t entry_size = sizeof(secp256k1_ge) + sizeof(secp256k1_scalar) + sizeof(struct secp256k1_pippenger_point_state) + (WNAF_SIZE(bucket_window+1)+1)*sizeof(int);
-    return ((1<<bucket_window) * sizeof(secp256k1_gej) + sizeof(struct secp256k1_pippenger_state) + entries * entry_size);
+    return (secp256k1_pippenger_bucket_scratch_size(n_points, bucket_window) + sizeof(struct secp256k1_pippenger_state) + entries * entry_size);
 }
 
-static int secp256k1_ecmult_pippenger_batch(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
+struct secp256k1_pippenger_window_job {
+    secp256k1_gej *buckets;
+    const struct secp256k1_pippenger_affine_state *affine;
+    struct secp256k1_pippenger_affine_state affine_space;
+    int bucket_window;
+    const struct secp256k1_pippenger_state *state;
+    const secp256k1_ge *pt;
+    size_t no;
+    int lo;
+    int hi;
+    secp256k1_gej r;
+};
+
+static void secp256k1_ecmult_pippenger_window_job(void *job_data, size_t idx) {
+    struct secp256k1_pippenger_window_job *job = &((struct secp256k1_pippenger_window_job *) job_data)[idx];
+    secp256k1_ecmult_pippenger_windows(job->buckets, job->affine, job->bucket_window, job->state, &job->r, job->pt, job->no, job->lo, job->hi);
+}
+
+/**
+ * Returns the scratch size required in addition to secp256k1_pippenger_scratch_size
+ * when the windows of a batch are split over n_jobs jobs, each with its own buckets.
+ */
+static size_t secp256k1_pippenger_jobs_scratch_size(size_t n_points, int bucket_window, size_t n_jobs) {
+    return (n_jobs - 1) * secp256k1_pippenger_bucket_scratch_size(n_points, bucket_window) + n_jobs * sizeof(struct secp256k1_pippenger_window_job);
+}
+
+/*
+ * Computes a batch with Pippenger's algorithm. If executor is not NULL, the
+ * wnaf windows are split into up to n_jobs contiguous ranges which are run
+ * through the executor, each accumulating into its own buckets. The partial
+ * results are combined afterwards by shifting them into place with doublings.
+ * This requires PIPPENGER_SCRATCH_OBJECTS + 1 objects and
+ * secp256k1_pippenger_jobs_scratch_size(n_points, bucket_window, n_jobs) bytes of extra
+ * scratch space.
+ */
+static int secp256k1_ecmult_pippenger_batch_jobs(const secp256k1_ecmult_context *ctx, const secp256k1_executor *executor, size_t n_jobs, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
     /* Use 2(n+1) with the endomorphism, n+1 without, when calculating batch
      * sizes. The reason for +1 is that we add the G scalar to the list of
      * other scalars. */
@@ -862,12 +1280,16 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_ecmult_context *ctx,
 #endif
     secp256k1_ge *points;
     secp256k1_scalar *scalars;
-    secp256k1_gej *buckets;
+    secp256k1_gej *buckets = NULL;
+    struct secp256k1_pippenger_affine_state affine_space;
     struct secp256k1_pippenger_state *state_space;
+    struct secp256k1_pippenger_window_job *jobs = NULL;
+    int affine;
     size_t idx = 0;
     size_t point_idx = 0;
     int i, j;
     int bucket_window;
+    int n_wnaf;
 
     (void)ctx;
     secp256k1_gej_set_infinity(r);
@@ -876,15 +1298,36 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_ecmult_context *ctx,
     }
 
     bucket_window = secp256k1_pippenger_bucket_window(n_points);
-    if (!secp256k1_scratch_allocate_frame(scratch, secp256k1_pippenger_scratch_size(n_points, bucket_window), PIPPENGER_SCRATCH_OBJECTS)) {
-        return 0;
+    affine = bucket_window >= PIPPENGER_AFFINE_MIN_BUCKET_WINDOW;
+    n_wnaf = WNAF_SIZE(bucket_window+1);
+    if (executor == NULL || n_jobs < 1) {
+        n_jobs = 1;
+    } else if (n_jobs > (size_t)n_wnaf) {
+        n_jobs = n_wnaf;
+    }
+    if (executor == NULL) {
+        if (!secp256k1_scratch_allocate_frame(scratch, secp256k1_pippenger_scratch_size(n_points, bucket_window), PIPPENGER_SCRATCH_OBJECTS)) {
+            return 0;
+        }
+    } else {
+        if (!secp256k1_scratch_allocate_frame(scratch, secp256k1_pippenger_scratch_size(n_points, bucket_window) + secp256k1_pippenger_jobs_scratch_size(n_points, bucket_window, n_jobs), PIPPENGER_SCRATCH_OBJECTS + 1)) {
+            return 0;
+        }
+        jobs = (struct secp256k1_pippenger_window_job *) secp256k1_scratch_alloc(scratch, n_jobs * sizeof(*jobs));
     }
     points = (secp256k1_ge *) secp256k1_scratch_alloc(scratch, entries * sizeof(*points));
     scalars = (secp256k1_scalar *) secp256k1_scratch_alloc(scratch, entries * sizeof(*scalars));
     state_space = (struct secp256k1_pippenger_state *) secp256k1_scratch_alloc(scratch, sizeof(*state_space));
     state_space->ps = (struct secp256k1_pippenger_point_state *) secp256k1_scratch_alloc(scratch, entries * sizeof(*state_space->ps));
     state_space->wnaf_na = (int *) secp256k1_scratch_alloc(scratch, entries*(WNAF_SIZE(bucket_window+1)) * sizeof(int));
-    buckets = (secp256k1_gej *) secp256k1_scratch_alloc(scratch, (1<<bucket_window) * sizeof(*buckets));
+    if (affine) {
+        affine_space.acc = (secp256k1_ge *) secp256k1_scratch_alloc(scratch, n_jobs * entries * sizeof(secp256k1_ge));
+        affine_space.den = (secp256k1_fe *) secp256k1_scratch_alloc(scratch, n_jobs * entries * sizeof(secp256k1_fe));
+        affine_space.start = (size_t *) secp256k1_scratch_alloc(scratch, n_jobs * 2 * (1<<bucket_window) * sizeof(size_t));
+        affine_space.len = affine_space.start + (1<<bucket_window);
+    } else {
+        buckets = (secp256k1_gej *) secp256k1_scratch_alloc(scratch, n_jobs * (1<<bucket_window) * sizeof(*buckets));
+    }
 
     if (inp_g_sc != NULL) {
         scalars[0] = *inp_g_sc;
@@ -909,7 +1352,41 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_ecmult_context *ctx,
         point_idx++;
     }
 
-    secp256k1_ecmult_pippenger_wnaf(buckets, bucket_window, state_space, r, scalars, points, idx);
+    if (executor == NULL) {
+        secp256k1_ecmult_pippenger_wnaf(buckets, affine ? &affine_space : NULL, bucket_window, state_space, r, scalars, points, idx);
+    } else {
+        size_t no = secp256k1_ecmult_pippenger_wnaf_init(bucket_window, state_space, scalars, points, idx);
+        size_t k;
+        if (no > 0) {
+            for (k = 0; k < n_jobs; k++) {
+                if (affine) {
+                    jobs[k].affine_space.acc = &affine_space.acc[k * entries];
+                    jobs[k].affine_space.den = &affine_space.den[k * entries];
+                    jobs[k].affine_space.start = &affine_space.start[k * 2 * (1<<bucket_window)];
+                    jobs[k].affine_space.len = jobs[k].affine_space.start + (1<<bucket_window);
+                    jobs[k].affine = &jobs[k].affine_space;
+                    jobs[k].buckets = NULL;
+                } else {
+                    jobs[k].affine = NULL;
+                    jobs[k].buckets = &buckets[k * (1<<bucket_window)];
+                }
+                jobs[k].bucket_window = bucket_window;
+                jobs[k].state = state_space;
+                jobs[k].pt = points;
+                jobs[k].no = no;
+                jobs[k].lo = (n_wnaf * k) / n_jobs;
+                jobs[k].hi = (n_wnaf * (k + 1)) / n_jobs;
+            }
+            executor->run(secp256k1_ecmult_pippenger_window_job, jobs, n_jobs, executor->data);
+            /* r = sum_k 2^((bucket_window+1)*lo_k) * r_k, evaluated from the top range down. */
+            for (k = n_jobs; k > 0; k--) {
+                for (j = 0; j < (bucket_window+1) * (jobs[k-1].hi - jobs[k-1].lo); j++) {
+                    secp256k1_gej_double_var(r, r, NULL);
+                }
+                secp256k1_gej_add_var(r, r, &jobs[k-1].r, NULL);
+            }
+        }
+    }
 
     /* Clear data */
     for(i = 0; (size_t)i < idx; i++) {
@@ -919,13 +1396,23 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_ecmult_context *ctx,
             state_space->wnaf_na[i * WNAF_SIZE(bucket_window+1) + j] = 0;
         }
     }
-    for(i = 0; i < 1<<bucket_window; i++) {
-        secp256k1_gej_clear(&buckets[i]);
+    if (affine) {
+        for(i = 0; (size_t)i < n_jobs * entries; i++) {
+            secp256k1_ge_clear(&affine_space.acc[i]);
+        }
+    } else {
+        for(i = 0; (size_t)i < n_jobs * (1<<bucket_window); i++) {
+            secp256k1_gej_clear(&buckets[i]);
+        }
     }
     secp256k1_scratch_deallocate_frame(scratch);
     return 1;
 }
 
+static int secp256k1_ecmult_pippenger_batch(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
+    return secp256k1_ecmult_pippenger_batch_jobs(ctx, NULL, 1, scratch, r, inp_g_sc, cb, cbdata, n_points, cb_offset);
+}
+
 /* Wrapper for secp256k1_ecmult_multi_func interface */
 static int secp256k1_ecmult_pippenger_batch_single(const secp256k1_ecmult_context *actx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
     return secp256k1_ecmult_pippenger_batch(actx, scratch, r, inp_g_sc, cb, cbdata, n, 0);
@@ -945,13 +1432,10 @@ static size_t secp256k1_pippenger_max_points(secp256k1_scratch *scratch) {
         size_t n_points;
         size_t max_points = secp256k1_pippenger_bucket_window_inv(bucket_window);
         size_t space_for_points;
-        size_t space_overhead;
-        size_t entry_size = sizeof(secp256k1_ge) + sizeof(secp256k1_scalar) + sizeof(struct secp256k1_pippenger_point_state) + (WNAF_SIZE(bucket_window+1)+1)*sizeof(int);
+        /* The scratch size is affine in the number of points. */
+        size_t space_overhead = secp256k1_pippenger_scratch_size(0, bucket_window);
+        size_t entry_size = secp256k1_pippenger_scratch_size(1, bucket_window) - space_overhead;
 
-#ifdef USE_ENDOMORPHISM
-        entry_size = 2*entry_size;
-#endif
-        space_overhead = ((1<<bucket_window) * sizeof(secp256k1_gej) + entry_size + sizeof(struct secp256k1_pippenger_state));
         if (space_overhead > max_alloc) {
             break;
         }
@@ -1024,4 +1508,144 @@ static int secp256k1_ecmult_multi_var(const secp256k1_ecmult_context *ctx, secp2
     return 1;
 }
 
+struct secp256k1_ecmult_multi_worker {
+    const secp256k1_ecmult_context *ctx;
+    secp256k1_scratch *scratch;
+    int (*f)(const secp256k1_ecmult_context*, secp256k1_scratch*, secp256k1_gej*, const secp256k1_scalar*, secp256k1_ecmult_multi_callback cb, void*, size_t, size_t);
+    const secp256k1_scalar *inp_g_sc;
+    secp256k1_ecmult_multi_callback *cb;
+    void *cbdata;
+    size_t n;
+    size_t n_batches;
+    size_t n_batch_points;
+    size_t n_workers;
+    /* Sum of the batches processed by this worker */
+    secp256k1_gej r;
+    int ret;
+};
+
+/* Worker idx computes the batches idx, idx + n_workers, idx + 2*n_workers, ... */
+static void secp256k1_ecmult_multi_worker_job(void *job_data, size_t idx) {
+    struct secp256k1_ecmult_multi_worker *worker = &((struct secp256k1_ecmult_multi_worker *) job_data)[idx];
+    size_t i;
+
+    secp256k1_gej_set_infinity(&worker->r);
+    worker->ret = 1;
+    for (i = idx; i < worker->n_batches; i += worker->n_workers) {
+        size_t offset = worker->n_batch_points*i;
+        size_t nbp = worker->n - offset < worker->n_batch_points ? worker->n - offset : worker->n_batch_points;
+        secp256k1_gej tmp;
+        if (!worker->f(worker->ctx, worker->scratch, &tmp, i == 0 ? worker->inp_g_sc : NULL, worker->cb, worker->cbdata, nbp, offset)) {
+            worker->ret = 0;
+            return;
+        }
+        secp256k1_gej_add_var(&worker->r, &worker->r, &tmp, NULL);
+    }
+}
+
+static int secp256k1_ecmult_multi_var_parallel(const secp256k1_ecmult_context *ctx, const secp256k1_executor *executor, secp256k1_scratch **scratch, size_t n_scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+    struct secp256k1_ecmult_multi_worker *workers;
+    int (*f)(const secp256k1_ecmult_context*, secp256k1_scratch*, secp256k1_gej*, const secp256k1_scalar*, secp256k1_ecmult_multi_callback cb, void*, size_t, size_t);
+    size_t max_points = 0;
+    size_t n_batches;
+    size_t n_batch_points;
+    size_t n_workers;
+    size_t i;
+    int ret = 1;
+
+    VERIFY_CHECK(n_scratch > 0);
+    secp256k1_gej_set_infinity(r);
+    if (n_scratch == 1 || n <= 1) {
+        return secp256k1_ecmult_multi_var(ctx, scratch[0], r, inp_g_sc, cb, cbdata, n);
+    }
+
+    /* If all points fit in a single Pippenger batch in the first scratch
+     * space, split the work by wnaf windows rather than by points. That keeps
+     * the bucket accumulation shared by all points and costs only the
+     * doublings needed to combine the per-window results. */
+    if (n >= ECMULT_PIPPENGER_THRESHOLD && n <= ECMULT_MAX_POINTS_PER_BATCH) {
+        int bucket_window = secp256k1_pippenger_bucket_window(n);
+        size_t n_jobs = n_scratch < (size_t)WNAF_SIZE(bucket_window+1) ? n_scratch : (size_t)WNAF_SIZE(bucket_window+1);
+        if (secp256k1_pippenger_scratch_size(n, bucket_window) + secp256k1_pippenger_jobs_scratch_size(n, bucket_window, n_jobs) <= secp256k1_scratch_max_allocation(scratch[0], PIPPENGER_SCRATCH_OBJECTS + 1)) {
+            return secp256k1_ecmult_pippenger_batch_jobs(ctx, executor, n_jobs, scratch[0], r, inp_g_sc, cb, cbdata, n, 0);
+        }
+    }
+
+    /* The worker states live in the first scratch space; every scratch space
+     * must be able to hold a batch after that. */
+    if (!secp256k1_scratch_allocate_frame(scratch[0], n_scratch * sizeof(*workers), 1)) {
+        return 0;
+    }
+    workers = (struct secp256k1_ecmult_multi_worker *) secp256k1_scratch_alloc(scratch[0], n_scratch * sizeof(*workers));
+
+    /* All workers use the same batch size, so use the smallest scratch space to
+     * determine it. There are at least as many batches as workers (unless there
+     * are fewer points than that), so that every worker gets something to do. */
+    for (i = 0; i < n_scratch; i++) {
+        size_t mp = secp256k1_pippenger_max_points(scratch[i]);
+        if (i == 0 || mp < max_points) {
+            max_points = mp;
+        }
+    }
+    if (max_points == 0) {
+        secp256k1_scratch_deallocate_frame(scratch[0]);
+        return 0;
+    } else if (max_points > ECMULT_MAX_POINTS_PER_BATCH) {
+        max_points = ECMULT_MAX_POINTS_PER_BATCH;
+    }
+    n_batches = (n+max_points-1)/max_points;
+    if (n_batches < n_scratch) {
+        n_batches = n < n_scratch ? n : n_scratch;
+    }
+    n_batch_points = (n+n_batches-1)/n_batches;
+
+    if (n_batch_points >= ECMULT_PIPPENGER_THRESHOLD) {
+        f = secp256k1_ecmult_pippenger_batch;
+    } else {
+        for (i = 0; i < n_scratch; i++) {
+            size_t mp = secp256k1_strauss_max_points(scratch[i]);
+            if (i == 0 || mp < max_points) {
+                max_points = mp;
+            }
+        }
+        if (max_points == 0) {
+            secp256k1_scratch_deallocate_frame(scratch[0]);
+            return 0;
+        }
+        n_batches = (n+max_points-1)/max_points;
+        if (n_batches < n_scratch) {
+            n_batches = n < n_scratch ? n : n_scratch;
+        }
+        n_batch_points = (n+n_batches-1)/n_batches;
+        f = secp256k1_ecmult_strauss_batch;
+    }
+    /* Rounding up the batch size may leave the last batches empty. */
+    n_batches = (n+n_batch_points-1)/n_batch_points;
+    n_workers = n_batches < n_scratch ? n_batches : n_scratch;
+
+    for (i = 0; i < n_workers; i++) {
+        workers[i].ctx = ctx;
+        workers[i].scratch = scratch[i];
+        workers[i].f = f;
+        workers[i].inp_g_sc = inp_g_sc;
+        workers[i].cb = cb;
+        workers[i].cbdata = cbdata;
+        workers[i].n = n;
+        workers[i].n_batches = n_batches;
+        workers[i].n_batch_points = n_batch_points;
+        workers[i].n_workers = n_workers;
+    }
+    executor->run(secp256k1_ecmult_multi_worker_job, workers, n_workers, executor->data);
+
+    for (i = 0; i < n_workers; i++) {
+        ret &= workers[i].ret;
+        secp256k1_gej_add_var(r, r, &workers[i].r, NULL);
+    }
+    secp256k1_scratch_deallocate_frame(scratch[0]);
+    if (!ret) {
+        secp256k1_gej_set_infinity(r);
+    }
+    return ret;
+}
+
 #endif /* SECP256K1_ECMULT_IMPL_H */
@@ -11,8 +11,8 @@
  * - December 2014, Pieter Wuille: converted from YASM to GCC inline assembly
  */
 
-#ifndef SECP256K1_FIELD_INNER5X52_IMPL_H
-#define SECP256K1_FIELD_INNER5X52_IMPL_H
+#ifndef SECP256K1_FIELD_INNER5X52_ASM_IMPL_H
+#define SECP256K1_FIELD_INNER5X52_ASM_IMPL_H
 
 SECP256K1_INLINE static void secp256k1_fe_mul_inner(uint64_t *r, const uint64_t *a, const uint64_t * SECP256K1_RESTRICT b) {
 /**
@@ -499,4 +499,4 @@ __asm__ __volatile__(
 );
 }
 
-#endif /* SECP256K1_FIELD_INNER5X52_IMPL_H */
+#endif /* SECP256K1_FIELD_INNER5X52_ASM_IMPL_H */
@@ -0,0 +1,459 @@
+/**********************************************************************
+ * Copyright (c) 2018 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef SECP256K1_FIELD_INNER5X52_BMI2_IMPL_H
+#define SECP256K1_FIELD_INNER5X52_BMI2_IMPL_H
+
+/** The steps of field_5x52_int128_impl.h using mulx, which takes its destination registers
+ *  explicitly, so the first product of c and d lands in place and the reductions multiply by R
+ *  without shuffling through rax. The sums stay on add/adc: adcx/adox would chain the low and
+ *  high halves of each 128-bit accumulator through a single flag, which is slower.
+ *  Only used with USE_RUNTIME_DISPATCH, on CPUs that support BMI2 and ADX. */
+
+SECP256K1_INLINE static void secp256k1_fe_mul_inner_bmi2(uint64_t *r, const uint64_t *a, const uint64_t * SECP256K1_RESTRICT b) {
+/**
+ * Registers: rdx     = multiplicand, rdx:rax = product
+ *            r9:r8   = c
+ *            r15:rcx = d
+ *            r10-r14 = a0-a4
+ *            rbx     = b
+ *            rdi     = r
+ */
+  uint64_t tmp1, tmp2, tmp3;
+__asm__ __volatile__(
+    "movq 0(%%rsi),%%r10\n"
+    "movq 8(%%rsi),%%r11\n"
+    "movq 16(%%rsi),%%r12\n"
+    "movq 24(%%rsi),%%r13\n"
+    "movq 32(%%rsi),%%r14\n"
+    /* d = a0 * b3 */
+    "movq %%r10,%%rdx\n"
+    "mulxq 24(%%rbx),%%rcx,%%r15\n"
+    /* c = a4 * b4 */
+    "movq %%r14,%%rdx\n"
+    "mulxq 32(%%rbx),%%r8,%%r9\n"
+    /* d += a1 * b2 */
+    "movq %%r11,%%rdx\n"
+    "mulxq 16(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* d += a2 * b1 */
+    "movq %%r12,%%rdx\n"
+    "mulxq 8(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* d += a3 * b0 */
+    "movq %%r13,%%rdx\n"
+    "mulxq 0(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* d += (c & M) * R */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rax,%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* c >>= 52 */
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* t3 (tmp1) = d & M */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%rcx,%%rax\n"
+    "movq %%rax,%q1\n"
+    /* d >>= 52 */
+    "shrdq $52,%%r15,%%rcx\n"
+    "xorq %%r15,%%r15\n"
+    /* d += a0 * b4 */
+    "movq %%r10,%%rdx\n"
+    "mulxq 32(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* d += a1 * b3 */
+    "movq %%r11,%%rdx\n"
+    "mulxq 24(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* d += a2 * b2 */
+    "movq %%r12,%%rdx\n"
+    "mulxq 16(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* d += a3 * b1 */
+    "movq %%r13,%%rdx\n"
+    "mulxq 8(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* d += a4 * b0 */
+    "movq %%r14,%%rdx\n"
+    "mulxq 0(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* d += c * R */
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%r8,%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* t4 = d & M, tx = t4 >> 48 (tmp3), t4 &= (M >> 4) (tmp2) */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%rcx,%%rax\n"
+    "movq %%rax,%%rdx\n"
+    "shrq $48,%%rdx\n"
+    "movq %%rdx,%q3\n"
+    "movq $0xffffffffffff,%%rdx\n"
+    "andq %%rdx,%%rax\n"
+    "movq %%rax,%q2\n"
+    /* d >>= 52 */
+    "shrdq $52,%%r15,%%rcx\n"
+    "xorq %%r15,%%r15\n"
+    /* c = a0 * b0 */
+    "movq %%r10,%%rdx\n"
+    "mulxq 0(%%rbx),%%r8,%%r9\n"
+    /* d += a1 * b4 */
+    "movq %%r11,%%rdx\n"
+    "mulxq 32(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* d += a2 * b3 */
+    "movq %%r12,%%rdx\n"
+    "mulxq 24(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* d += a3 * b2 */
+    "movq %%r13,%%rdx\n"
+    "mulxq 16(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* d += a4 * b1 */
+    "movq %%r14,%%rdx\n"
+    "mulxq 8(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* u0 = ((d & M) << 4) | tx */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%rcx,%%rax\n"
+    "shlq $4,%%rax\n"
+    "orq %q3,%%rax\n"
+    /* d >>= 52 */
+    "shrdq $52,%%r15,%%rcx\n"
+    "xorq %%r15,%%r15\n"
+    /* c += u0 * (R >> 4) */
+    "movq $0x1000003d1,%%rdx\n"
+    "mulxq %%rax,%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* r[0] = c & M */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq %%rax,0(%%rdi)\n"
+    /* c >>= 52 */
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* c += a0 * b1 */
+    "movq %%r10,%%rdx\n"
+    "mulxq 8(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* d += a2 * b4 */
+    "movq %%r12,%%rdx\n"
+    "mulxq 32(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* c += a1 * b0 */
+    "movq %%r11,%%rdx\n"
+    "mulxq 0(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* d += a3 * b3 */
+    "movq %%r13,%%rdx\n"
+    "mulxq 24(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* d += a4 * b2 */
+    "movq %%r14,%%rdx\n"
+    "mulxq 16(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* c += (d & M) * R */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%rcx,%%rax\n"
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rax,%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* d >>= 52 */
+    "shrdq $52,%%r15,%%rcx\n"
+    "xorq %%r15,%%r15\n"
+    /* r[1] = c & M */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq %%rax,8(%%rdi)\n"
+    /* c >>= 52 */
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* c += a0 * b2 */
+    "movq %%r10,%%rdx\n"
+    "mulxq 16(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* d += a3 * b4 */
+    "movq %%r13,%%rdx\n"
+    "mulxq 32(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* c += a1 * b1 */
+    "movq %%r11,%%rdx\n"
+    "mulxq 8(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* d += a4 * b3 */
+    "movq %%r14,%%rdx\n"
+    "mulxq 24(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r15\n"
+    /* c += a2 * b0 */
+    "movq %%r12,%%rdx\n"
+    "mulxq 0(%%rbx),%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* c += (d & M) * R */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%rcx,%%rax\n"
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rax,%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* d >>= 52 */
+    "shrdq $52,%%r15,%%rcx\n"
+    "xorq %%r15,%%r15\n"
+    /* r[2] = c & M */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq %%rax,16(%%rdi)\n"
+    /* c >>= 52 */
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* c += t3 */
+    "addq %q1,%%r8\n"
+    "adcq $0,%%r9\n"
+    /* c += d * R */
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rcx,%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* r[3] = c & M */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq %%rax,24(%%rdi)\n"
+    /* r[4] = (c >> 52) + t4 */
+    "shrdq $52,%%r9,%%r8\n"
+    "addq %q2,%%r8\n"
+    "movq %%r8,32(%%rdi)\n"
+: "+S"(a), "=m"(tmp1), "=m"(tmp2), "=m"(tmp3)
+: "b"(b), "D"(r)
+: "%rax", "%rcx", "%rdx", "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15", "cc", "memory"
+);
+}
+
+SECP256K1_INLINE static void secp256k1_fe_sqr_inner_bmi2(uint64_t *r, const uint64_t *a) {
+/**
+ * Registers: rdx     = multiplicand, rdx:rax = product
+ *            r9:r8   = c
+ *            rbx:rcx = d
+ *            r10-r14 = a0-a4
+ *            rdi     = r
+ */
+  uint64_t tmp1, tmp2, tmp3;
+__asm__ __volatile__(
+    "movq 0(%%rsi),%%r10\n"
+    "movq 8(%%rsi),%%r11\n"
+    "movq 16(%%rsi),%%r12\n"
+    "movq 24(%%rsi),%%r13\n"
+    "movq 32(%%rsi),%%r14\n"
+    /* d = (a0*2) * a3 */
+    "leaq (%%r10,%%r10),%%rdx\n"
+    "mulxq %%r13,%%rcx,%%rbx\n"
+    /* c = a4 * a4 */
+    "movq %%r14,%%rdx\n"
+    "mulxq %%r14,%%r8,%%r9\n"
+    /* d += (a1*2) * a2 */
+    "leaq (%%r11,%%r11),%%rdx\n"
+    "mulxq %%r12,%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%rbx\n"
+    /* d += (c & M) * R */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rax,%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%rbx\n"
+    /* c >>= 52 */
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* t3 (tmp1) = d & M */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%rcx,%%rax\n"
+    "movq %%rax,%q1\n"
+    /* d >>= 52 */
+    "shrdq $52,%%rbx,%%rcx\n"
+    "xorq %%rbx,%%rbx\n"
+    /* a4 *= 2 */
+    "addq %%r14,%%r14\n"
+    /* d += a0 * a4 */
+    "movq %%r10,%%rdx\n"
+    "mulxq %%r14,%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%rbx\n"
+    /* d += (a1*2) * a3 */
+    "leaq (%%r11,%%r11),%%rdx\n"
+    "mulxq %%r13,%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%rbx\n"
+    /* d += a2 * a2 */
+    "movq %%r12,%%rdx\n"
+    "mulxq %%r12,%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%rbx\n"
+    /* d += c * R */
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%r8,%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%rbx\n"
+    /* t4 = d & M, tx = t4 >> 48 (tmp3), t4 &= (M >> 4) (tmp2) */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%rcx,%%rax\n"
+    "movq %%rax,%%rdx\n"
+    "shrq $48,%%rdx\n"
+    "movq %%rdx,%q3\n"
+    "movq $0xffffffffffff,%%rdx\n"
+    "andq %%rdx,%%rax\n"
+    "movq %%rax,%q2\n"
+    /* d >>= 52 */
+    "shrdq $52,%%rbx,%%rcx\n"
+    "xorq %%rbx,%%rbx\n"
+    /* c = a0 * a0 */
+    "movq %%r10,%%rdx\n"
+    "mulxq %%r10,%%r8,%%r9\n"
+    /* d += a1 * a4 */
+    "movq %%r11,%%rdx\n"
+    "mulxq %%r14,%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%rbx\n"
+    /* d += (a2*2) * a3 */
+    "leaq (%%r12,%%r12),%%rdx\n"
+    "mulxq %%r13,%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%rbx\n"
+    /* u0 = ((d & M) << 4) | tx */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%rcx,%%rax\n"
+    "shlq $4,%%rax\n"
+    "orq %q3,%%rax\n"
+    /* d >>= 52 */
+    "shrdq $52,%%rbx,%%rcx\n"
+    "xorq %%rbx,%%rbx\n"
+    /* c += u0 * (R >> 4) */
+    "movq $0x1000003d1,%%rdx\n"
+    "mulxq %%rax,%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* r[0] = c & M */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq %%rax,0(%%rdi)\n"
+    /* c >>= 52 */
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* a0 *= 2 */
+    "addq %%r10,%%r10\n"
+    /* c += a0 * a1 */
+    "movq %%r10,%%rdx\n"
+    "mulxq %%r11,%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* d += a2 * a4 */
+    "movq %%r12,%%rdx\n"
+    "mulxq %%r14,%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%rbx\n"
+    /* d += a3 * a3 */
+    "movq %%r13,%%rdx\n"
+    "mulxq %%r13,%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%rbx\n"
+    /* c += (d & M) * R */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%rcx,%%rax\n"
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rax,%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* d >>= 52 */
+    "shrdq $52,%%rbx,%%rcx\n"
+    "xorq %%rbx,%%rbx\n"
+    /* r[1] = c & M */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq %%rax,8(%%rdi)\n"
+    /* c >>= 52 */
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* c += a0 * a2 */
+    "movq %%r10,%%rdx\n"
+    "mulxq %%r12,%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* d += a3 * a4 */
+    "movq %%r13,%%rdx\n"
+    "mulxq %%r14,%%rax,%%rdx\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%rbx\n"
+    /* c += a1 * a1 */
+    "movq %%r11,%%rdx\n"
+    "mulxq %%r11,%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* c += (d & M) * R */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%rcx,%%rax\n"
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rax,%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* d >>= 52 */
+    "shrdq $52,%%rbx,%%rcx\n"
+    "xorq %%rbx,%%rbx\n"
+    /* r[2] = c & M */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq %%rax,16(%%rdi)\n"
+    /* c >>= 52 */
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* c += t3 */
+    "addq %q1,%%r8\n"
+    "adcq $0,%%r9\n"
+    /* c += d * R */
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rcx,%%rax,%%rdx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* r[3] = c & M */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq %%rax,24(%%rdi)\n"
+    /* r[4] = (c >> 52) + t4 */
+    "shrdq $52,%%r9,%%r8\n"
+    "addq %q2,%%r8\n"
+    "movq %%r8,32(%%rdi)\n"
+: "+S"(a), "=m"(tmp1), "=m"(tmp2), "=m"(tmp3)
+: "D"(r)
+: "%rax", "%rbx", "%rcx", "%rdx", "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15", "cc", "memory"
+);
+}
+
+#endif /* SECP256K1_FIELD_INNER5X52_BMI2_IMPL_H */
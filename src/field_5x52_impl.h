@@ -15,12 +15,54 @@
 #include "num.h"
 #include "field.h"
 
-#if defined(USE_ASM_X86_64)
+#if defined(USE_RUNTIME_DISPATCH)
+#include "dispatch_impl.h"
+/* Build every kernel under its own name, and choose one on each call. The choice is forced inline
+ * so that the kernels still inline into their callers: a call per multiplication costs more than
+ * BMI2 saves. */
+#define secp256k1_fe_mul_inner secp256k1_fe_mul_inner_generic
+#define secp256k1_fe_sqr_inner secp256k1_fe_sqr_inner_generic
+#include "field_5x52_int128_impl.h"
+#undef secp256k1_fe_mul_inner
+#undef secp256k1_fe_sqr_inner
+#define secp256k1_fe_mul_inner secp256k1_fe_mul_inner_x86_64
+#define secp256k1_fe_sqr_inner secp256k1_fe_sqr_inner_x86_64
+#include "field_5x52_asm_impl.h"
+#undef secp256k1_fe_mul_inner
+#undef secp256k1_fe_sqr_inner
+#include "field_5x52_bmi2_impl.h"
+
+__attribute__((always_inline)) SECP256K1_INLINE static void secp256k1_fe_mul_inner(uint64_t *r, const uint64_t *a, const uint64_t * SECP256K1_RESTRICT b) {
+    int kernel = secp256k1_kernel_get();
+    if (kernel == SECP256K1_KERNEL_BMI2) {
+        secp256k1_fe_mul_inner_bmi2(r, a, b);
+    } else if (kernel == SECP256K1_KERNEL_X86_64) {
+        secp256k1_fe_mul_inner_x86_64(r, a, b);
+    } else {
+        secp256k1_fe_mul_inner_generic(r, a, b);
+    }
+}
+
+__attribute__((always_inline)) SECP256K1_INLINE static void secp256k1_fe_sqr_inner(uint64_t *r, const uint64_t *a) {
+    int kernel = secp256k1_kernel_get();
+    if (kernel == SECP256K1_KERNEL_BMI2) {
+        secp256k1_fe_sqr_inner_bmi2(r, a);
+    } else if (kernel == SECP256K1_KERNEL_X86_64) {
+        secp256k1_fe_sqr_inner_x86_64(r, a);
+    } else {
+        secp256k1_fe_sqr_inner_generic(r, a);
+    }
+}
+#elif defined(USE_ASM_X86_64)
 #include "field_5x52_asm_impl.h"
 #else
 #include "field_5x52_int128_impl.h"
 #endif
 
+#if defined(USE_FIELD_INV_SAFEGCD)
+#include "modinv64_impl.h"
+#endif
+
 /** Implements arithmetic modulo FFFFFFFF FFFFFFFF FFFFFFFF FFFFFFFF FFFFFFFF FFFFFFFF FFFFFFFE FFFFFC2F,
  *  represented as 5 uint64_t's in base 2^52. The values are allowed to contain >52 each. In particular,
  *  each FieldElem has a 'magnitude' associated with it. Internally, a magnitude M means each element
@@ -493,4 +535,90 @@ static SECP256K1_INLINE void secp256k1_fe_from_storage(secp256k1_fe *r, const se
 #endif
 }
 
+#if defined(USE_FIELD_INV_SAFEGCD)
+static void secp256k1_fe_from_signed62(secp256k1_fe *r, const secp256k1_modinv64_signed62 *a) {
+    const uint64_t M52 = UINT64_MAX >> 12;
+    const uint64_t a0 = a->v[0], a1 = a->v[1], a2 = a->v[2], a3 = a->v[3], a4 = a->v[4];
+
+    /* The output from secp256k1_modinv64{_var} is normalized to range [0,modulus), and has limbs
+     * in [0,2^62). The modulus is < 2^256, so the top limb must be below 2^(256-62*4). */
+    VERIFY_CHECK(a0 >> 62 == 0);
+    VERIFY_CHECK(a1 >> 62 == 0);
+    VERIFY_CHECK(a2 >> 62 == 0);
+    VERIFY_CHECK(a3 >> 62 == 0);
+    VERIFY_CHECK(a4 >> 8 == 0);
+
+    r->n[0] =  a0                   & M52;
+    r->n[1] = (a0 >> 52 | a1 << 10) & M52;
+    r->n[2] = (a1 >> 42 | a2 << 20) & M52;
+    r->n[3] = (a2 >> 32 | a3 << 30) & M52;
+    r->n[4] = (a3 >> 22 | a4 << 40);
+#ifdef VERIFY
+    r->magnitude = 1;
+    r->normalized = 1;
+    secp256k1_fe_verify(r);
+#endif
+}
+
+static void secp256k1_fe_to_signed62(secp256k1_modinv64_signed62 *r, const secp256k1_fe *a) {
+    const uint64_t M62 = UINT64_MAX >> 2;
+    const uint64_t a0 = a->n[0], a1 = a->n[1], a2 = a->n[2], a3 = a->n[3], a4 = a->n[4];
+#ifdef VERIFY
+    VERIFY_CHECK(a->normalized);
+#endif
+
+    r->v[0] = (a0       | a1 << 52) & M62;
+    r->v[1] = (a1 >> 10 | a2 << 42) & M62;
+    r->v[2] = (a2 >> 20 | a3 << 32) & M62;
+    r->v[3] = (a3 >> 30 | a4 << 22) & M62;
+    r->v[4] =  a4 >> 40;
+}
+
+/* The field prime 2^256 - 2^32 - 977 in signed62, and its inverse mod 2^62. */
+static const secp256k1_modinv64_modinfo secp256k1_const_modinfo_fe = {
+    {{-0x1000003D1LL, 0, 0, 0, 256}},
+    0x27C7F6E22DDACACFULL
+};
+
+static void secp256k1_fe_inv(secp256k1_fe *r, const secp256k1_fe *x) {
+    secp256k1_fe tmp = *x;
+    secp256k1_modinv64_signed62 s;
+
+    secp256k1_fe_normalize(&tmp);
+    secp256k1_fe_to_signed62(&s, &tmp);
+    secp256k1_modinv64(&s, &secp256k1_const_modinfo_fe);
+    secp256k1_fe_from_signed62(r, &s);
+}
+
+static void secp256k1_fe_inv_var(secp256k1_fe *r, const secp256k1_fe *x) {
+    secp256k1_fe tmp = *x;
+    secp256k1_modinv64_signed62 s;
+
+    secp256k1_fe_normalize_var(&tmp);
+    secp256k1_fe_to_signed62(&s, &tmp);
+    secp256k1_modinv64_var(&s, &secp256k1_const_modinfo_fe);
+    secp256k1_fe_from_signed62(r, &s);
+}
+
+static int secp256k1_fe_is_quad_var(const secp256k1_fe *x) {
+    secp256k1_fe tmp = *x;
+    secp256k1_modinv64_signed62 s;
+    int jac;
+
+    secp256k1_fe_normalize_var(&tmp);
+    if (secp256k1_fe_is_zero(&tmp)) {
+        return 1;
+    }
+    secp256k1_fe_to_signed62(&s, &tmp);
+    jac = secp256k1_jacobi64_maybe_var(&s, &secp256k1_const_modinfo_fe);
+    if (jac == 0) {
+        /* The Jacobi symbol computation gave up, which is rare for random inputs (and more
+         * common in VERIFY builds). Fall back to computing a square root. */
+        secp256k1_fe dummy;
+        return secp256k1_fe_sqrt(&dummy, &tmp);
+    }
+    return jac > 0;
+}
+#endif
+
 #endif /* SECP256K1_FIELD_REPR_IMPL_H */
@@ -11,6 +11,8 @@
 #include "field_impl.h"
 #include "scalar_impl.h"
 #include "group_impl.h"
+#include "ecmult_impl.h"
+#include "scratch_impl.h"
 #include "ecmult_gen_impl.h"
 
 static void default_error_callback_fn(const char* str, void* data) {
@@ -24,15 +26,87 @@ static const secp256k1_callback default_error_callback = {
     NULL
 };
 
+/* The largest window size the static verification tables can be used for. */
+#define STATIC_WINDOW_G 16
+
+static void print_table(FILE *fp, const char *name, const secp256k1_ge_storage *table) {
+    int i, w;
+    fprintf(fp, "static const secp256k1_ge_storage %s[ECMULT_TABLE_SIZE(WINDOW_G)] = {\n", name);
+    for (i = 0; i != ECMULT_TABLE_SIZE(STATIC_WINDOW_G); i++) {
+        /* The table for a window w is the prefix of the table for w + 1, so
+         * cut it off at every window size. */
+        for (w = 2; w < STATIC_WINDOW_G; w++) {
+            if (i == ECMULT_TABLE_SIZE(w)) {
+                fprintf(fp, "#if WINDOW_G > %d\n", w);
+            }
+        }
+        fprintf(fp, "    SC(%uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu),\n", SECP256K1_GE_STORAGE_CONST_GET(table[i]));
+    }
+    for (w = 2; w < STATIC_WINDOW_G; w++) {
+        fprintf(fp, "#endif\n");
+    }
+    fprintf(fp, "};\n");
+}
+
+static int write_pre_g(void) {
+    secp256k1_ge_storage *table;
+    secp256k1_gej gj;
+    int i;
+    FILE* fp;
+
+    fp = fopen("src/ecmult_static_pre_g.h","w");
+    if (fp == NULL) {
+        fprintf(stderr, "Could not open src/ecmult_static_pre_g.h for writing!\n");
+        return -1;
+    }
+
+    fprintf(fp, "#ifndef _SECP256K1_ECMULT_STATIC_PRE_G_\n");
+    fprintf(fp, "#define _SECP256K1_ECMULT_STATIC_PRE_G_\n");
+    fprintf(fp, "#include \"src/group.h\"\n");
+    fprintf(fp, "#if WINDOW_G > %d\n", STATIC_WINDOW_G);
+    fprintf(fp, "#error configuration mismatch, invalid WINDOW_G. Try deleting ecmult_static_pre_g.h before the build.\n");
+    fprintf(fp, "#endif\n");
+    fprintf(fp, "#define SC SECP256K1_GE_STORAGE_CONST\n");
+
+    table = (secp256k1_ge_storage*)checked_malloc(&default_error_callback, sizeof(*table) * ECMULT_TABLE_SIZE(STATIC_WINDOW_G));
+
+    /* odd multiples of the generator */
+    secp256k1_gej_set_ge(&gj, &secp256k1_ge_const_g);
+    secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(STATIC_WINDOW_G), table, &gj, &default_error_callback);
+    print_table(fp, "secp256k1_ecmult_static_pre_g", table);
+
+    /* odd multiples of 2^128*generator */
+    for (i = 0; i < 128; i++) {
+        secp256k1_gej_double_var(&gj, &gj, NULL);
+    }
+    secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(STATIC_WINDOW_G), table, &gj, &default_error_callback);
+    fprintf(fp, "#ifdef USE_ENDOMORPHISM\n");
+    print_table(fp, "secp256k1_ecmult_static_pre_g_128", table);
+    fprintf(fp, "#endif\n");
+
+    free(table);
+
+    fprintf(fp, "#undef SC\n");
+    fprintf(fp, "#endif\n");
+    fclose(fp);
+
+    return 0;
+}
+
 int main(int argc, char **argv) {
     secp256k1_ecmult_gen_context ctx;
-    int inner;
-    int outer;
+    int block;
+    int point;
     FILE* fp;
 
     (void)argc;
     (void)argv;
 
+    /* Written first, so that ecmult_static_context.h is never older. */
+    if (write_pre_g() != 0) {
+        return -1;
+    }
+
     fp = fopen("src/ecmult_static_context.h","w");
     if (fp == NULL) {
         fprintf(stderr, "Could not open src/ecmult_static_context.h for writing!\n");
@@ -42,22 +116,25 @@ int main(int argc, char **argv) {
     fprintf(fp, "#ifndef _SECP256K1_ECMULT_STATIC_CONTEXT_\n");
     fprintf(fp, "#define _SECP256K1_ECMULT_STATIC_CONTEXT_\n");
     fprintf(fp, "#include \"src/group.h\"\n");
+    fprintf(fp, "#if COMB_BLOCKS != %d || COMB_TEETH != %d\n", COMB_BLOCKS, COMB_TEETH);
+    fprintf(fp, "#error configuration mismatch, invalid COMB_BLOCKS or COMB_TEETH. Try deleting ecmult_static_context.h before the build.\n");
+    fprintf(fp, "#endif\n");
     fprintf(fp, "#define SC SECP256K1_GE_STORAGE_CONST\n");
-    fprintf(fp, "static const secp256k1_ge_storage secp256k1_ecmult_static_context[64][16] = {\n");
+    fprintf(fp, "static const secp256k1_ge_storage secp256k1_ecmult_static_context[COMB_BLOCKS][COMB_POINTS] = {\n");
 
     secp256k1_ecmult_gen_context_init(&ctx);
     secp256k1_ecmult_gen_context_build(&ctx, &default_error_callback);
-    for(outer = 0; outer != 64; outer++) {
+    for(block = 0; block != COMB_BLOCKS; block++) {
         fprintf(fp,"{\n");
-        for(inner = 0; inner != 16; inner++) {
-            fprintf(fp,"    SC(%uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu)", SECP256K1_GE_STORAGE_CONST_GET((*ctx.prec)[outer][inner]));
-            if (inner != 15) {
+        for(point = 0; point != COMB_POINTS; point++) {
+            fprintf(fp,"    SC(%uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu)", SECP256K1_GE_STORAGE_CONST_GET((*ctx.prec)[block][point]));
+            if (point != COMB_POINTS - 1) {
                 fprintf(fp,",\n");
             } else {
                 fprintf(fp,"\n");
             }
         }
-        if (outer != 63) {
+        if (block != COMB_BLOCKS - 1) {
             fprintf(fp,"},\n");
         } else {
             fprintf(fp,"}\n");
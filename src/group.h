@@ -67,6 +67,17 @@ static void secp256k1_ge_set_gej(secp256k1_ge *r, secp256k1_gej *a);
 /** Set a batch of group elements equal to the inputs given in jacobian coordinates */
 static void secp256k1_ge_set_all_gej_var(secp256k1_ge *r, const secp256k1_gej *a, size_t len, const secp256k1_callback *cb);
 
+/** Set a batch of group elements equal to the inputs given in jacobian coordinates, in constant
+ *  time and with a single field inversion. None of the inputs may be infinity, and r and a must
+ *  not overlap. */
+static void secp256k1_ge_set_all_gej(secp256k1_ge *r, const secp256k1_gej *a, size_t len);
+
+/** Set r[i] = a + b[i] for a batch of affine inputs, in constant time and with a single field
+ *  inversion. d must have room for len field elements. Returns 0, leaving r undefined, if some
+ *  b[i] has the same x coordinate as a. None of the inputs may be infinity, and r must not
+ *  overlap with a or b. */
+static int secp256k1_ge_add_all_ge(secp256k1_ge *r, secp256k1_fe *d, const secp256k1_ge *a, const secp256k1_ge *b, size_t len);
+
 /** Set a batch of group elements equal to the inputs given in jacobian
  *  coordinates (with known z-ratios). zr must contain the known z-ratios such
  *  that mul(a[i].z, zr[i+1]) == a[i+1].z. zr[0] is ignored. */
@@ -141,6 +152,9 @@ static void secp256k1_ge_from_storage(secp256k1_ge *r, const secp256k1_ge_storag
 /** If flag is true, set *r equal to *a; otherwise leave it. Constant-time. */
 static void secp256k1_ge_storage_cmov(secp256k1_ge_storage *r, const secp256k1_ge_storage *a, int flag);
 
+/** If flag is true, set *r equal to *a; otherwise leave it. Constant-time. */
+static void secp256k1_gej_cmov(secp256k1_gej *r, const secp256k1_gej *a, int flag);
+
 /** Rescale a jacobian point by b which must be non-zero. Constant-time. */
 static void secp256k1_gej_rescale(secp256k1_gej *r, const secp256k1_fe *b);
 
@@ -152,6 +152,90 @@ static void secp256k1_ge_set_all_gej_var(secp256k1_ge *r, const secp256k1_gej *a
     free(azi);
 }
 
+static void secp256k1_ge_set_all_gej(secp256k1_ge *r, const secp256k1_gej *a, size_t len) {
+    secp256k1_fe u;
+    secp256k1_fe zi;
+    size_t i;
+    if (len < 1) {
+        return;
+    }
+
+    /* The products of the first i + 1 z coordinates are kept in r[i].x. */
+    VERIFY_CHECK(!a[0].infinity);
+    r[0].x = a[0].z;
+    for (i = 1; i < len; i++) {
+        VERIFY_CHECK(!a[i].infinity);
+        secp256k1_fe_mul(&r[i].x, &r[i - 1].x, &a[i].z);
+    }
+
+    secp256k1_fe_inv(&u, &r[len - 1].x);
+
+    for (i = len - 1; i > 0; i--) {
+        secp256k1_fe_mul(&zi, &r[i - 1].x, &u);
+        secp256k1_fe_mul(&u, &u, &a[i].z);
+        secp256k1_ge_set_gej_zinv(&r[i], &a[i], &zi);
+    }
+    secp256k1_ge_set_gej_zinv(&r[0], &a[0], &u);
+}
+
+/* Set r = a + b given the inverse of x(b) - x(a), using negations nax and nay of a's coordinates. */
+static void secp256k1_ge_add_ge_dinv(secp256k1_ge *r, const secp256k1_ge *a, const secp256k1_fe *nax, const secp256k1_fe *nay, const secp256k1_ge *b, const secp256k1_fe *di) {
+    secp256k1_fe lambda, t;
+    lambda = b->y;
+    secp256k1_fe_add(&lambda, nay);
+    secp256k1_fe_mul(&lambda, &lambda, di);
+    secp256k1_fe_sqr(&r->x, &lambda);
+    secp256k1_fe_add(&r->x, nax);
+    secp256k1_fe_negate(&t, &b->x, 1);
+    secp256k1_fe_add(&r->x, &t);
+    secp256k1_fe_normalize_weak(&r->x);
+    secp256k1_fe_negate(&t, &r->x, 1);
+    secp256k1_fe_add(&t, &a->x);
+    secp256k1_fe_mul(&r->y, &lambda, &t);
+    secp256k1_fe_add(&r->y, nay);
+    secp256k1_fe_normalize_weak(&r->y);
+    r->infinity = 0;
+}
+
+static int secp256k1_ge_add_all_ge(secp256k1_ge *r, secp256k1_fe *d, const secp256k1_ge *a, const secp256k1_ge *b, size_t len) {
+    secp256k1_fe nax, nay, u, di;
+    size_t i;
+    int ret = 1;
+    if (len < 1) {
+        return 1;
+    }
+
+    /* The denominators x(b[i]) - x(a) are kept in r[i].x, and the products of the first
+     * i + 1 of them in d[i]. */
+    VERIFY_CHECK(!a->infinity);
+    secp256k1_fe_negate(&nax, &a->x, 1);
+    secp256k1_fe_negate(&nay, &a->y, 1);
+    for (i = 0; i < len; i++) {
+        VERIFY_CHECK(!b[i].infinity);
+        r[i].x = b[i].x;
+        secp256k1_fe_add(&r[i].x, &nax);
+        ret &= !secp256k1_fe_normalizes_to_zero(&r[i].x);
+        if (i == 0) {
+            d[0] = r[0].x;
+        } else {
+            secp256k1_fe_mul(&d[i], &d[i - 1], &r[i].x);
+        }
+    }
+    if (!ret) {
+        return 0;
+    }
+
+    secp256k1_fe_inv(&u, &d[len - 1]);
+
+    for (i = len - 1; i > 0; i--) {
+        secp256k1_fe_mul(&di, &d[i - 1], &u);
+        secp256k1_fe_mul(&u, &u, &r[i].x);
+        secp256k1_ge_add_ge_dinv(&r[i], a, &nax, &nay, &b[i], &di);
+    }
+    secp256k1_ge_add_ge_dinv(&r[0], a, &nax, &nay, &b[0], &u);
+    return 1;
+}
+
 static void secp256k1_ge_set_table_gej_var(secp256k1_ge *r, const secp256k1_gej *a, const secp256k1_fe *zr, size_t len) {
     size_t i = len - 1;
     secp256k1_fe zi;
@@ -678,6 +762,13 @@ static SECP256K1_INLINE void secp256k1_ge_storage_cmov(secp256k1_ge_storage *r,
     secp256k1_fe_storage_cmov(&r->y, &a->y, flag);
 }
 
+static SECP256K1_INLINE void secp256k1_gej_cmov(secp256k1_gej *r, const secp256k1_gej *a, int flag) {
+    secp256k1_fe_cmov(&r->x, &a->x, flag);
+    secp256k1_fe_cmov(&r->y, &a->y, flag);
+    secp256k1_fe_cmov(&r->z, &a->z, flag);
+    r->infinity ^= (r->infinity ^ a->infinity) & -(flag != 0);
+}
+
 #ifdef USE_ENDOMORPHISM
 static void secp256k1_ge_mul_lambda(secp256k1_ge *r, const secp256k1_ge *a) {
     static const secp256k1_fe beta = SECP256K1_FE_CONST(
@@ -0,0 +1,460 @@
+/**********************************************************************
+ * Copyright (c) 2018 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef SECP256K1_MODINV32_IMPL_H
+#define SECP256K1_MODINV32_IMPL_H
+
+#include "modinv32.h"
+
+#include "util.h"
+
+/* This file implements the same algorithm as modinv64_impl.h (see the explanation there), using
+ * 30-bit limbs and batches of 30 divsteps so that only 64-bit wide multiplications are needed. */
+
+/* Data type for storing a 2x2 transition matrix; its entries are scaled by 2^30. */
+typedef struct {
+    int32_t u, v, q, r;
+} secp256k1_modinv32_trans2x2;
+
+/* Take as input a signed30 number in range (-2*modulus,modulus), and add a multiple of the
+ * modulus to it to bring it to range [0,modulus). If sign < 0, the input is negated in the
+ * process. The input must have limbs in range (-2^30,2^30). The output will have limbs in
+ * range [0,2^30). */
+static void secp256k1_modinv32_normalize_30(secp256k1_modinv32_signed30 *r, int32_t sign, const secp256k1_modinv32_modinfo *modinfo) {
+    const int32_t M30 = (int32_t)(UINT32_MAX >> 2);
+    int32_t cond_add, cond_negate;
+    int i;
+
+    /* In a previous step, r was in range (-2*modulus,modulus). Add modulus if r is negative. */
+    cond_add = r->v[8] >> 31;
+    for (i = 0; i < 9; ++i) {
+        r->v[i] += modinfo->modulus.v[i] & cond_add;
+    }
+    /* Now r is in range (-modulus,modulus). Negate it if sign is negative. */
+    cond_negate = sign >> 31;
+    for (i = 0; i < 9; ++i) {
+        r->v[i] = (r->v[i] ^ cond_negate) - cond_negate;
+    }
+    /* Propagate the top bits, to bring limbs back to range (-2^30,2^30). */
+    for (i = 0; i < 8; ++i) {
+        r->v[i + 1] += r->v[i] >> 30;
+        r->v[i] &= M30;
+    }
+
+    /* Still in range (-modulus,modulus). Add modulus once more if r is negative. */
+    cond_add = r->v[8] >> 31;
+    for (i = 0; i < 9; ++i) {
+        r->v[i] += modinfo->modulus.v[i] & cond_add;
+    }
+    for (i = 0; i < 8; ++i) {
+        r->v[i + 1] += r->v[i] >> 30;
+        r->v[i] &= M30;
+    }
+
+#ifdef VERIFY
+    for (i = 0; i < 9; ++i) {
+        VERIFY_CHECK(r->v[i] >> 30 == 0);
+    }
+#endif
+}
+
+/* Compute the transition matrix and eta for 30 divsteps, in constant time.
+ *
+ * Input:  eta: initial eta
+ *         f0:  bottom limb of initial f
+ *         g0:  bottom limb of initial g
+ * Output: t: transition matrix
+ * Return: final eta
+ */
+static int32_t secp256k1_modinv32_divsteps_30(int32_t eta, uint32_t f0, uint32_t g0, secp256k1_modinv32_trans2x2 *t) {
+    /* u,v,q,r are the elements of the transformation matrix being built up, starting with the
+     * identity. They are signed integers in range [-2^30,2^30], but represented as unsigned
+     * mod 2^32 here, which permits left shifting them. */
+    uint32_t u = 1, v = 0, q = 0, r = 1;
+    uint32_t c1, c2, f = f0, g = g0, x, y, z;
+    int i;
+
+    for (i = 0; i < 30; ++i) {
+        VERIFY_CHECK((f & 1) == 1); /* f must always be odd */
+        VERIFY_CHECK((u * f0 + v * g0) == f << i);
+        VERIFY_CHECK((q * f0 + r * g0) == g << i);
+        /* Compute conditional masks for (eta < 0) and for (g & 1). */
+        c1 = eta >> 31;
+        c2 = -(g & 1);
+        /* Compute x,y,z, conditionally negated versions of f,u,v. */
+        x = (f ^ c1) - c1;
+        y = (u ^ c1) - c1;
+        z = (v ^ c1) - c1;
+        /* Conditionally add x,y,z to g,q,r. */
+        g += x & c2;
+        q += y & c2;
+        r += z & c2;
+        /* In what follows, c1 is a condition mask for (eta < 0) and (g & 1). */
+        c1 &= c2;
+        /* Conditionally negate eta, and unconditionally subtract 1. */
+        eta = (eta ^ (int32_t)c1) - (c1 + 1);
+        /* Conditionally add g,q,r to f,u,v. */
+        f += g & c1;
+        u += q & c1;
+        v += r & c1;
+        /* Shifts */
+        g >>= 1;
+        u <<= 1;
+        v <<= 1;
+    }
+    t->u = (int32_t)u;
+    t->v = (int32_t)v;
+    t->q = (int32_t)q;
+    t->r = (int32_t)r;
+    return eta;
+}
+
+/* secp256k1_modinv32_inv256[i] = -(2*i+1)^-1 (mod 256) */
+static const uint8_t secp256k1_modinv32_inv256[128] = {
+    0xFF, 0x55, 0x33, 0x49, 0xC7, 0x5D, 0x3B, 0x11, 0x0F, 0xE5, 0xC3, 0x59,
+    0xD7, 0xED, 0xCB, 0x21, 0x1F, 0x75, 0x53, 0x69, 0xE7, 0x7D, 0x5B, 0x31,
+    0x2F, 0x05, 0xE3, 0x79, 0xF7, 0x0D, 0xEB, 0x41, 0x3F, 0x95, 0x73, 0x89,
+    0x07, 0x9D, 0x7B, 0x51, 0x4F, 0x25, 0x03, 0x99, 0x17, 0x2D, 0x0B, 0x61,
+    0x5F, 0xB5, 0x93, 0xA9, 0x27, 0xBD, 0x9B, 0x71, 0x6F, 0x45, 0x23, 0xB9,
+    0x37, 0x4D, 0x2B, 0x81, 0x7F, 0xD5, 0xB3, 0xC9, 0x47, 0xDD, 0xBB, 0x91,
+    0x8F, 0x65, 0x43, 0xD9, 0x57, 0x6D, 0x4B, 0xA1, 0x9F, 0xF5, 0xD3, 0xE9,
+    0x67, 0xFD, 0xDB, 0xB1, 0xAF, 0x85, 0x63, 0xF9, 0x77, 0x8D, 0x6B, 0xC1,
+    0xBF, 0x15, 0xF3, 0x09, 0x87, 0x1D, 0xFB, 0xD1, 0xCF, 0xA5, 0x83, 0x19,
+    0x97, 0xAD, 0x8B, 0xE1, 0xDF, 0x35, 0x13, 0x29, 0xA7, 0x3D, 0x1B, 0xF1,
+    0xEF, 0xC5, 0xA3, 0x39, 0xB7, 0xCD, 0xAB, 0x01
+};
+
+/* Compute the transition matrix and eta for 30 divsteps, in variable time. See
+ * secp256k1_modinv64_divsteps_62_var. */
+static int32_t secp256k1_modinv32_divsteps_30_var(int32_t eta, uint32_t f0, uint32_t g0, secp256k1_modinv32_trans2x2 *t) {
+    uint32_t u = 1, v = 0, q = 0, r = 1;
+    uint32_t f = f0, g = g0, m, w;
+    int i = 30, limit, zeros;
+
+    for (;;) {
+        /* Use a sentinel bit to count zeros only up to i. */
+        zeros = secp256k1_ctz32_var(g | (UINT32_MAX << i));
+        /* Perform zeros divsteps at once; they all just divide g by two. */
+        g >>= zeros;
+        u <<= zeros;
+        v <<= zeros;
+        eta -= zeros;
+        i -= zeros;
+        /* We're done once we've done 30 divsteps. */
+        if (i == 0) {
+            break;
+        }
+        VERIFY_CHECK((f & 1) == 1);
+        VERIFY_CHECK((g & 1) == 1);
+        VERIFY_CHECK((u * f0 + v * g0) == f << (30 - i));
+        VERIFY_CHECK((q * f0 + r * g0) == g << (30 - i));
+        /* If eta is negative, negate it and replace f,g with g,-f. */
+        if (eta < 0) {
+            uint32_t tmp;
+            eta = -eta;
+            tmp = f; f = g; g = -tmp;
+            tmp = u; u = q; q = -tmp;
+            tmp = v; v = r; r = -tmp;
+        }
+        /* eta is now >= 0. Cancel out the bottom min(i, eta+1, 8) bits of g at once. */
+        limit = ((int)eta + 1) > i ? i : ((int)eta + 1);
+        m = (UINT32_MAX >> (32 - limit)) & 255U;
+        w = (g * secp256k1_modinv32_inv256[(f >> 1) & 127]) & m;
+        g += f * w;
+        q += u * w;
+        r += v * w;
+        VERIFY_CHECK((g & m) == 0);
+    }
+    t->u = (int32_t)u;
+    t->v = (int32_t)v;
+    t->q = (int32_t)q;
+    t->r = (int32_t)r;
+    return eta;
+}
+
+/* Compute (t/2^30) * [d, e] mod modulus, where t is a transition matrix for 30 divsteps.
+ *
+ * On input and output, d and e are in range (-2*modulus,modulus). All output limbs will be in
+ * range (-2^30,2^30).
+ */
+static void secp256k1_modinv32_update_de_30(secp256k1_modinv32_signed30 *d, secp256k1_modinv32_signed30 *e, const secp256k1_modinv32_trans2x2 *t, const secp256k1_modinv32_modinfo *modinfo) {
+    const uint32_t M30 = UINT32_MAX >> 2;
+    const int32_t u = t->u, v = t->v, q = t->q, r = t->r;
+    int32_t di, ei, md, me, sd, se;
+    int64_t cd, ce;
+    int i;
+
+    /* [md,me] start as zero; plus [u,q] if d is negative; plus [v,r] if e is negative. */
+    sd = d->v[8] >> 31;
+    se = e->v[8] >> 31;
+    md = (u & sd) + (v & se);
+    me = (q & sd) + (r & se);
+    /* Begin computing t*[d,e]. */
+    di = d->v[0];
+    ei = e->v[0];
+    cd = (int64_t)u * di + (int64_t)v * ei;
+    ce = (int64_t)q * di + (int64_t)r * ei;
+    /* Correct md,me so that t*[d,e]+modulus*[md,me] has 30 zero bottom bits. */
+    md -= (modinfo->modulus_inv30 * (uint32_t)cd + md) & M30;
+    me -= (modinfo->modulus_inv30 * (uint32_t)ce + me) & M30;
+    /* Update the beginning of computation for t*[d,e]+modulus*[md,me] now md,me are known. */
+    cd += (int64_t)modinfo->modulus.v[0] * md;
+    ce += (int64_t)modinfo->modulus.v[0] * me;
+    /* Verify that the low 30 bits of the computation are indeed zero, and then throw them away. */
+    VERIFY_CHECK(((uint32_t)cd & M30) == 0);
+    VERIFY_CHECK(((uint32_t)ce & M30) == 0);
+    cd >>= 30;
+    ce >>= 30;
+    /* Now iteratively compute limb i=1..8 of t*[d,e]+modulus*[md,me], and store them in output
+     * limb i-1 (shifting down by 30 bits). */
+    for (i = 1; i < 9; ++i) {
+        di = d->v[i];
+        ei = e->v[i];
+        cd += (int64_t)u * di + (int64_t)v * ei;
+        ce += (int64_t)q * di + (int64_t)r * ei;
+        cd += (int64_t)modinfo->modulus.v[i] * md;
+        ce += (int64_t)modinfo->modulus.v[i] * me;
+        d->v[i - 1] = (int32_t)((uint32_t)cd & M30); cd >>= 30;
+        e->v[i - 1] = (int32_t)((uint32_t)ce & M30); ce >>= 30;
+    }
+    /* What remains is limb 9 of t*[d,e]+modulus*[md,me]; store it as output limb 8. */
+    d->v[8] = (int32_t)cd;
+    e->v[8] = (int32_t)ce;
+}
+
+/* Compute (t/2^30) * [f, g], where t is a transition matrix for 30 divsteps.
+ *
+ * Only the bottom len limbs of f and g are processed; the limbs above are assumed to be the
+ * sign extension of the top one.
+ */
+static void secp256k1_modinv32_update_fg_30(int len, secp256k1_modinv32_signed30 *f, secp256k1_modinv32_signed30 *g, const secp256k1_modinv32_trans2x2 *t) {
+    const uint32_t M30 = UINT32_MAX >> 2;
+    const int32_t u = t->u, v = t->v, q = t->q, r = t->r;
+    int32_t fi, gi;
+    int64_t cf, cg;
+    int i;
+    VERIFY_CHECK(len > 0);
+
+    /* Start computing t*[f,g]. */
+    fi = f->v[0];
+    gi = g->v[0];
+    cf = (int64_t)u * fi + (int64_t)v * gi;
+    cg = (int64_t)q * fi + (int64_t)r * gi;
+    /* Verify that the bottom 30 bits of the result are zero, and then throw them away. */
+    VERIFY_CHECK(((uint32_t)cf & M30) == 0);
+    VERIFY_CHECK(((uint32_t)cg & M30) == 0);
+    cf >>= 30;
+    cg >>= 30;
+    /* Now iteratively compute limb i=1..len-1 of t*[f,g], and store them in output limb i-1
+     * (shifting down by 30 bits). */
+    for (i = 1; i < len; ++i) {
+        fi = f->v[i];
+        gi = g->v[i];
+        cf += (int64_t)u * fi + (int64_t)v * gi;
+        cg += (int64_t)q * fi + (int64_t)r * gi;
+        f->v[i - 1] = (int32_t)((uint32_t)cf & M30); cf >>= 30;
+        g->v[i - 1] = (int32_t)((uint32_t)cg & M30); cg >>= 30;
+    }
+    /* What remains is limb len of t*[f,g]; store it as output limb len-1. */
+    f->v[len - 1] = (int32_t)cf;
+    g->v[len - 1] = (int32_t)cg;
+}
+
+static void secp256k1_modinv32(secp256k1_modinv32_signed30 *x, const secp256k1_modinv32_modinfo *modinfo) {
+    /* Start with d=0, e=1, f=modulus, g=x, eta=-1. */
+    secp256k1_modinv32_signed30 d = {{0, 0, 0, 0, 0, 0, 0, 0, 0}};
+    secp256k1_modinv32_signed30 e = {{1, 0, 0, 0, 0, 0, 0, 0, 0}};
+    secp256k1_modinv32_signed30 f = modinfo->modulus;
+    secp256k1_modinv32_signed30 g = *x;
+    int32_t eta = -1;
+    int i;
+
+    /* Do 25 iterations of 30 divsteps each = 750 divsteps. 741 suffice for 256-bit inputs. */
+    for (i = 0; i < 25; ++i) {
+        secp256k1_modinv32_trans2x2 t;
+        eta = secp256k1_modinv32_divsteps_30(eta, f.v[0], g.v[0], &t);
+        secp256k1_modinv32_update_de_30(&d, &e, &t, modinfo);
+        secp256k1_modinv32_update_fg_30(9, &f, &g, &t);
+    }
+
+    /* At this point g is 0 and (if g was not originally 0) f must now equal +/- GCD of the
+     * initial f, g values i.e. +/- 1, and d now contains +/- the modular inverse. */
+    VERIFY_CHECK((g.v[0] | g.v[1] | g.v[2] | g.v[3] | g.v[4] | g.v[5] | g.v[6] | g.v[7] | g.v[8]) == 0);
+
+    /* Optionally negate d, normalize to [0,modulus), and return it. */
+    secp256k1_modinv32_normalize_30(&d, f.v[8], modinfo);
+    *x = d;
+}
+
+static void secp256k1_modinv32_var(secp256k1_modinv32_signed30 *x, const secp256k1_modinv32_modinfo *modinfo) {
+    /* Start with d=0, e=1, f=modulus, g=x, eta=-1. */
+    secp256k1_modinv32_signed30 d = {{0, 0, 0, 0, 0, 0, 0, 0, 0}};
+    secp256k1_modinv32_signed30 e = {{1, 0, 0, 0, 0, 0, 0, 0, 0}};
+    secp256k1_modinv32_signed30 f = modinfo->modulus;
+    secp256k1_modinv32_signed30 g = *x;
+    int j, len = 9;
+    int32_t eta = -1;
+    int32_t cond, fn, gn;
+
+    /* Do iterations of 30 divsteps each until g=0. */
+    for (;;) {
+        secp256k1_modinv32_trans2x2 t;
+        eta = secp256k1_modinv32_divsteps_30_var(eta, f.v[0], g.v[0], &t);
+        secp256k1_modinv32_update_de_30(&d, &e, &t, modinfo);
+        secp256k1_modinv32_update_fg_30(len, &f, &g, &t);
+        /* If the bottom limb of g is zero, there is a chance that g=0. */
+        if (g.v[0] == 0) {
+            cond = 0;
+            /* Check if the other limbs are also 0. */
+            for (j = 1; j < len; ++j) {
+                cond |= g.v[j];
+            }
+            /* If so, we're done. */
+            if (cond == 0) {
+                break;
+            }
+        }
+
+        /* Determine if len>1 and limb (len-1) of both f and g is 0 or -1. */
+        fn = f.v[len - 1];
+        gn = g.v[len - 1];
+        cond = ((int32_t)len - 2) >> 31;
+        cond |= fn ^ (fn >> 31);
+        cond |= gn ^ (gn >> 31);
+        /* If so, reduce length, propagating the sign of f and g's top limb into the one below. */
+        if (cond == 0) {
+            f.v[len - 2] |= (int32_t)((uint32_t)fn << 30);
+            g.v[len - 2] |= (int32_t)((uint32_t)gn << 30);
+            --len;
+        }
+    }
+
+    /* At this point g is 0 and (if g was not originally 0) f must now equal +/- GCD of the
+     * initial f, g values i.e. +/- 1, and d now contains +/- the modular inverse. */
+
+    /* Optionally negate d, normalize to [0,modulus), and return it. */
+    secp256k1_modinv32_normalize_30(&d, f.v[len - 1], modinfo);
+    *x = d;
+}
+
+/* Compute the transition matrix and eta for 30 posdivsteps, in variable time, and update the
+ * bottom bit of *jacp with the changes of the Jacobi symbol (g | f). See
+ * secp256k1_modinv64_posdivsteps_62_var; f0 and g0 hold the bottom 32 bits of f and g. */
+static int32_t secp256k1_modinv32_posdivsteps_30_var(int32_t eta, uint32_t f0, uint32_t g0, secp256k1_modinv32_trans2x2 *t, int *jacp) {
+    uint32_t u = 1, v = 0, q = 0, r = 1;
+    uint32_t f = f0, g = g0, m, w;
+    int i = 30, limit, zeros;
+    int jac = *jacp;
+
+    for (;;) {
+        /* Use a sentinel bit to count zeros only up to i. */
+        zeros = secp256k1_ctz32_var(g | (UINT32_MAX << i));
+        /* Perform zeros divsteps at once; they all just divide g by two. */
+        g >>= zeros;
+        u <<= zeros;
+        v <<= zeros;
+        eta -= zeros;
+        i -= zeros;
+        /* Dividing g by an odd power of two flips the Jacobi symbol iff f is 3 or 5 mod 8. */
+        jac ^= (zeros & ((f >> 1) ^ (f >> 2)));
+        /* We're done once we've done 30 posdivsteps. */
+        if (i == 0) {
+            break;
+        }
+        VERIFY_CHECK((f & 1) == 1);
+        VERIFY_CHECK((g & 1) == 1);
+        VERIFY_CHECK((u * f0 + v * g0) == f << (30 - i));
+        VERIFY_CHECK((q * f0 + r * g0) == g << (30 - i));
+        /* If eta is negative, negate it and swap f,g. */
+        if (eta < 0) {
+            uint32_t tmp;
+            eta = -eta;
+            tmp = f; f = g; g = tmp;
+            tmp = u; u = q; q = tmp;
+            tmp = v; v = r; r = tmp;
+            /* Swapping f and g flips the Jacobi symbol iff both are 3 mod 4. */
+            jac ^= ((f & g) >> 1);
+        }
+        /* Cancel out the bottom min(i, eta+1, 8) bits of g, by adding a non-negative multiple
+         * of f (which does not change the Jacobi symbol). */
+        limit = ((int)eta + 1) > i ? i : ((int)eta + 1);
+        m = (UINT32_MAX >> (32 - limit)) & 255U;
+        w = (g * secp256k1_modinv32_inv256[(f >> 1) & 127]) & m;
+        g += f * w;
+        q += u * w;
+        r += v * w;
+        VERIFY_CHECK((g & m) == 0);
+    }
+    t->u = (int32_t)u;
+    t->v = (int32_t)v;
+    t->q = (int32_t)q;
+    t->r = (int32_t)r;
+    *jacp = jac;
+    return eta;
+}
+
+/* Give up after this many batches of posdivsteps; see SECP256K1_JACOBI64_ITERATIONS. */
+#ifdef VERIFY
+#define SECP256K1_JACOBI32_ITERATIONS 25
+#else
+#define SECP256K1_JACOBI32_ITERATIONS 50
+#endif
+
+static int secp256k1_jacobi32_maybe_var(const secp256k1_modinv32_signed30 *x, const secp256k1_modinv32_modinfo *modinfo) {
+    const int32_t M30 = (int32_t)(UINT32_MAX >> 2);
+    secp256k1_modinv32_signed30 f = modinfo->modulus;
+    secp256k1_modinv32_signed30 g = *x;
+    int j, len = 9;
+    int32_t eta = -1;
+    int32_t cond;
+    int jac = 0;
+    int count;
+
+#ifdef VERIFY
+    /* The input must be non-zero, with limbs in [0,2^30). */
+    cond = 0;
+    for (j = 0; j < 9; ++j) {
+        VERIFY_CHECK(g.v[j] >> 30 == 0);
+        cond |= g.v[j];
+    }
+    VERIFY_CHECK(cond != 0);
+#endif
+    /* Bring the modulus to limbs in [0,2^30) as well, so that its bottom 32 bits can be read
+     * off the bottom two limbs. */
+    for (j = 0; j < 8; ++j) {
+        f.v[j + 1] += f.v[j] >> 30;
+        f.v[j] &= M30;
+    }
+
+    for (count = 0; count < SECP256K1_JACOBI32_ITERATIONS; ++count) {
+        secp256k1_modinv32_trans2x2 t;
+        eta = secp256k1_modinv32_posdivsteps_30_var(eta, f.v[0] | ((uint32_t)f.v[1] << 30), g.v[0] | ((uint32_t)g.v[1] << 30), &t, &jac);
+        secp256k1_modinv32_update_fg_30(len, &f, &g, &t);
+        /* f and g stay positive, and converge to gcd(x, modulus) = 1. Once f is 1, the Jacobi
+         * symbol (g | f) is 1, so the answer is the sign tracked in jac. */
+        if (f.v[0] == 1) {
+            cond = 0;
+            for (j = 1; j < len; ++j) {
+                cond |= f.v[j];
+            }
+            if (cond == 0) {
+                return 1 - 2 * (jac & 1);
+            }
+        }
+        /* If len>1 and the top limbs of f and g are both 0, reduce the length. */
+        cond = ((int32_t)len - 2) >> 31;
+        cond |= f.v[len - 1];
+        cond |= g.v[len - 1];
+        if (cond == 0) {
+            --len;
+        }
+    }
+
+    /* The posdivsteps did not converge; the result is unknown. */
+    return 0;
+}
+
+#endif /* SECP256K1_MODINV32_IMPL_H */
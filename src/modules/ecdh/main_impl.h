@@ -10,6 +10,30 @@
 #include "include/secp256k1_ecdh.h"
 #include "ecmult_const_impl.h"
 
+struct secp256k1_ecdh_privkey_precomp_struct {
+    secp256k1_ecmult_const_recoding rec;
+};
+
+/** Hash the point pt in compressed form into result. */
+static void secp256k1_ecdh_hash(unsigned char *result, secp256k1_ge *pt) {
+    unsigned char x[32];
+    unsigned char y[1];
+    secp256k1_sha256 sha;
+
+    /* Compute a hash of the point in compressed form
+     * Note we cannot use secp256k1_eckey_pubkey_serialize here since it does not
+     * expect its output to be secret and has a timing sidechannel. */
+    secp256k1_fe_normalize(&pt->x);
+    secp256k1_fe_normalize(&pt->y);
+    secp256k1_fe_get_b32(x, &pt->x);
+    y[0] = 0x02 | secp256k1_fe_is_odd(&pt->y);
+
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, y, sizeof(y));
+    secp256k1_sha256_write(&sha, x, sizeof(x));
+    secp256k1_sha256_finalize(&sha, result);
+}
+
 int secp256k1_ecdh(const secp256k1_context* ctx, unsigned char *result, const secp256k1_pubkey *point, const unsigned char *scalar) {
     int ret = 0;
     int overflow = 0;
@@ -26,24 +50,9 @@ int secp256k1_ecdh(const secp256k1_context* ctx, unsigned char *result, const se
     if (overflow || secp256k1_scalar_is_zero(&s)) {
         ret = 0;
     } else {
-        unsigned char x[32];
-        unsigned char y[1];
-        secp256k1_sha256 sha;
-
         secp256k1_ecmult_const(&res, &pt, &s, 256);
         secp256k1_ge_set_gej(&pt, &res);
-        /* Compute a hash of the point in compressed form
-         * Note we cannot use secp256k1_eckey_pubkey_serialize here since it does not
-         * expect its output to be secret and has a timing sidechannel. */
-        secp256k1_fe_normalize(&pt.x);
-        secp256k1_fe_normalize(&pt.y);
-        secp256k1_fe_get_b32(x, &pt.x);
-        y[0] = 0x02 | secp256k1_fe_is_odd(&pt.y);
-
-        secp256k1_sha256_initialize(&sha);
-        secp256k1_sha256_write(&sha, y, sizeof(y));
-        secp256k1_sha256_write(&sha, x, sizeof(x));
-        secp256k1_sha256_finalize(&sha, result);
+        secp256k1_ecdh_hash(result, &pt);
         ret = 1;
     }
 
@@ -51,4 +60,111 @@ int secp256k1_ecdh(const secp256k1_context* ctx, unsigned char *result, const se
     return ret;
 }
 
+secp256k1_ecdh_privkey_precomp* secp256k1_ecdh_privkey_precomp_create(const secp256k1_context* ctx, const unsigned char *privkey) {
+    secp256k1_ecdh_privkey_precomp* ret;
+    secp256k1_scalar s;
+    int overflow = 0;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(privkey != NULL);
+
+    secp256k1_scalar_set_b32(&s, privkey, &overflow);
+    if (overflow || secp256k1_scalar_is_zero(&s)) {
+        secp256k1_scalar_clear(&s);
+        return NULL;
+    }
+    ret = (secp256k1_ecdh_privkey_precomp*)checked_malloc(&ctx->error_callback, sizeof(secp256k1_ecdh_privkey_precomp));
+    secp256k1_ecmult_const_recode(&ret->rec, &s, 256);
+    secp256k1_scalar_clear(&s);
+    return ret;
+}
+
+void secp256k1_ecdh_privkey_precomp_destroy(secp256k1_ecdh_privkey_precomp* precomp) {
+    if (precomp != NULL) {
+        memset(precomp, 0, sizeof(*precomp));
+        free(precomp);
+    }
+}
+
+int secp256k1_ecdh_precomp(const secp256k1_context* ctx, unsigned char *result, const secp256k1_pubkey *point, const secp256k1_ecdh_privkey_precomp *precomp) {
+    secp256k1_gej res;
+    secp256k1_ge pt;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(result != NULL);
+    ARG_CHECK(point != NULL);
+    ARG_CHECK(precomp != NULL);
+
+    secp256k1_pubkey_load(ctx, &pt, point);
+    secp256k1_ecmult_const_recoded(&res, &pt, &precomp->rec);
+    secp256k1_ge_set_gej(&pt, &res);
+    secp256k1_ecdh_hash(result, &pt);
+    return 1;
+}
+
+int secp256k1_ecdh_batch(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, unsigned char *output32s, const secp256k1_pubkey * const *points, size_t n, const unsigned char *scalar) {
+    secp256k1_ecmult_const_recoding rec;
+    secp256k1_gej *resj;
+    secp256k1_ge *res;
+    secp256k1_gej pj;
+    secp256k1_ge p;
+    secp256k1_scalar s;
+    size_t batch_size;
+    size_t i, j;
+    int overflow = 0;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(scratch != NULL);
+    ARG_CHECK(n == 0 || output32s != NULL);
+    ARG_CHECK(n == 0 || points != NULL);
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(points[i] != NULL);
+    }
+    ARG_CHECK(scalar != NULL);
+
+    secp256k1_scalar_set_b32(&s, scalar, &overflow);
+    if (overflow || secp256k1_scalar_is_zero(&s)) {
+        secp256k1_scalar_clear(&s);
+        if (n > 0) {
+            memset(output32s, 0, 32 * n);
+        }
+        return 0;
+    }
+    secp256k1_ecmult_const_recode(&rec, &s, 256);
+    secp256k1_scalar_clear(&s);
+
+    batch_size = secp256k1_scratch_max_allocation(scratch, 2) / (sizeof(secp256k1_gej) + sizeof(secp256k1_ge));
+    if (batch_size > n) {
+        batch_size = n;
+    }
+    if (batch_size == 0 || !secp256k1_scratch_allocate_frame(scratch, batch_size * (sizeof(secp256k1_gej) + sizeof(secp256k1_ge)), 2)) {
+        /* Not enough scratch space to share inversions; use a batch of one on the stack. */
+        batch_size = 1;
+        resj = &pj;
+        res = &p;
+    } else {
+        resj = (secp256k1_gej*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_gej));
+        res = (secp256k1_ge*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_ge));
+    }
+
+    /* The shared secrets are secret, so the constant-time batch conversion is used.
+     * None of them is infinity, as all points have the group order. */
+    for (i = 0; i < n; i += batch_size) {
+        size_t len = n - i < batch_size ? n - i : batch_size;
+        for (j = 0; j < len; j++) {
+            secp256k1_pubkey_load(ctx, &p, points[i + j]);
+            secp256k1_ecmult_const_recoded(&resj[j], &p, &rec);
+        }
+        secp256k1_ge_set_all_gej(res, resj, len);
+        for (j = 0; j < len; j++) {
+            secp256k1_ecdh_hash(&output32s[32 * (i + j)], &res[j]);
+        }
+    }
+
+    memset(resj, 0, batch_size * sizeof(secp256k1_gej));
+    memset(res, 0, batch_size * sizeof(secp256k1_ge));
+    if (resj != &pj) {
+        secp256k1_scratch_deallocate_frame(scratch);
+    }
+    memset(&rec, 0, sizeof(rec));
+    return 1;
+}
+
 #endif /* SECP256K1_MODULE_ECDH_MAIN_H */
@@ -96,10 +96,124 @@ void test_bad_scalar(void) {
     CHECK(secp256k1_ecdh(ctx, output, &point, s_overflow) == 1);
 }
 
+void test_ecdh_precomp(void) {
+    unsigned char s_zero[32] = { 0 };
+    unsigned char s_b32[32];
+    unsigned char output_ecdh[32];
+    unsigned char output_precomp[32];
+    secp256k1_ecdh_privkey_precomp *precomp;
+    secp256k1_pubkey point;
+    secp256k1_scalar s;
+    int32_t ecount = 0;
+    int i;
+
+    /* Include scalars whose recoding needs either skew, and ones close to the order. */
+    random_scalar_order(&s);
+    switch (secp256k1_rand_int(4)) {
+    case 0:
+        secp256k1_scalar_set_int(&s, 1 + secp256k1_rand_int(4));
+        break;
+    case 1:
+        secp256k1_scalar_set_int(&s, 1 + secp256k1_rand_int(4));
+        secp256k1_scalar_negate(&s, &s);
+        break;
+    }
+    secp256k1_scalar_get_b32(s_b32, &s);
+    precomp = secp256k1_ecdh_privkey_precomp_create(ctx, s_b32);
+    CHECK(precomp != NULL);
+    for (i = 0; i < 4; i++) {
+        unsigned char p_b32[32];
+        secp256k1_scalar p;
+        random_scalar_order(&p);
+        secp256k1_scalar_get_b32(p_b32, &p);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &point, p_b32) == 1);
+        CHECK(secp256k1_ecdh(ctx, output_ecdh, &point, s_b32) == 1);
+        CHECK(secp256k1_ecdh_precomp(ctx, output_precomp, &point, precomp) == 1);
+        CHECK(memcmp(output_ecdh, output_precomp, sizeof(output_ecdh)) == 0);
+    }
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ecdh_precomp(ctx, NULL, &point, precomp) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdh_precomp(ctx, output_precomp, NULL, precomp) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecdh_precomp(ctx, output_precomp, &point, NULL) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_ecdh_privkey_precomp_create(ctx, NULL) == NULL);
+    CHECK(ecount == 4);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_ecdh_privkey_precomp_destroy(precomp);
+    secp256k1_ecdh_privkey_precomp_destroy(NULL);
+
+    /* Invalid private keys cannot be prepared. */
+    CHECK(secp256k1_ecdh_privkey_precomp_create(ctx, s_zero) == NULL);
+    memset(s_b32, 0xff, sizeof(s_b32));
+    CHECK(secp256k1_ecdh_privkey_precomp_create(ctx, s_b32) == NULL);
+}
+
+void test_ecdh_batch(void) {
+    unsigned char s_b32[32];
+    unsigned char output_ecdh[32];
+    unsigned char output_batch[8 * 32];
+    unsigned char zeros[8 * 32] = { 0 };
+    secp256k1_pubkey point[8];
+    const secp256k1_pubkey *pointptr[8];
+    secp256k1_scratch_space *scratch;
+    secp256k1_scalar s;
+    size_t scratch_size;
+    size_t n = secp256k1_rand_int(8) + 1;
+    size_t i;
+    int32_t ecount = 0;
+
+    random_scalar_order(&s);
+    secp256k1_scalar_get_b32(s_b32, &s);
+    for (i = 0; i < n; i++) {
+        unsigned char p_b32[32];
+        secp256k1_scalar p;
+        random_scalar_order(&p);
+        secp256k1_scalar_get_b32(p_b32, &p);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &point[i], p_b32) == 1);
+        pointptr[i] = &point[i];
+    }
+
+    /* Exercise scratch spaces that hold no batch, part of the batch and all of it. */
+    scratch_size = secp256k1_rand_int(n * (sizeof(secp256k1_gej) + sizeof(secp256k1_ge)) + 1) + 2 * ALIGNMENT;
+    scratch = secp256k1_scratch_space_create(ctx, scratch_size);
+    CHECK(secp256k1_ecdh_batch(ctx, scratch, NULL, NULL, 0, s_b32) == 1);
+    CHECK(secp256k1_ecdh_batch(ctx, scratch, output_batch, pointptr, n, s_b32) == 1);
+    for (i = 0; i < n; i++) {
+        CHECK(secp256k1_ecdh(ctx, output_ecdh, &point[i], s_b32) == 1);
+        CHECK(memcmp(&output_batch[32 * i], output_ecdh, 32) == 0);
+    }
+
+    /* An invalid scalar clears all outputs. */
+    memset(s_b32, 0xff, sizeof(s_b32));
+    CHECK(secp256k1_ecdh_batch(ctx, scratch, output_batch, pointptr, n, s_b32) == 0);
+    CHECK(memcmp(output_batch, zeros, 32 * n) == 0);
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ecdh_batch(ctx, NULL, output_batch, pointptr, n, s_b32) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdh_batch(ctx, scratch, NULL, pointptr, n, s_b32) == 0);
+    CHECK(ecount == 2);
+    pointptr[n - 1] = NULL;
+    CHECK(secp256k1_ecdh_batch(ctx, scratch, output_batch, pointptr, n, s_b32) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_ecdh_batch(ctx, scratch, output_batch, pointptr, 0, NULL) == 0);
+    CHECK(ecount == 4);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_scratch_space_destroy(scratch);
+}
+
 void run_ecdh_tests(void) {
+    int i;
     test_ecdh_api();
     test_ecdh_generator_basepoint();
     test_bad_scalar();
+    for (i = 0; i < count; i++) {
+        test_ecdh_precomp();
+        test_ecdh_batch();
+    }
 }
 
 #endif /* SECP256K1_MODULE_ECDH_TESTS_H */
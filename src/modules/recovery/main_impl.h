@@ -84,13 +84,10 @@ int secp256k1_ecdsa_recoverable_signature_convert(const secp256k1_context* ctx,
     return 1;
 }
 
-static int secp256k1_ecdsa_sig_recover(const secp256k1_ecmult_context *ctx, const secp256k1_scalar *sigr, const secp256k1_scalar* sigs, secp256k1_ge *pubkey, const secp256k1_scalar *message, int recid) {
+/** Compute the point R of a signature from its r value and recovery id. */
+static int secp256k1_ecdsa_sig_recover_r(secp256k1_ge *x, const secp256k1_scalar *sigr, const secp256k1_scalar* sigs, int recid) {
     unsigned char brx[32];
     secp256k1_fe fx;
-    secp256k1_ge x;
-    secp256k1_gej xj;
-    secp256k1_scalar rn, u1, u2;
-    secp256k1_gej qj;
     int r;
 
     if (secp256k1_scalar_is_zero(sigr) || secp256k1_scalar_is_zero(sigs)) {
@@ -107,15 +104,32 @@ static int secp256k1_ecdsa_sig_recover(const secp256k1_ecmult_context *ctx, cons
         }
         secp256k1_fe_add(&fx, &secp256k1_ecdsa_const_order_as_fe);
     }
-    if (!secp256k1_ge_set_xo_var(&x, &fx, recid & 1)) {
+    return secp256k1_ge_set_xo_var(x, &fx, recid & 1);
+}
+
+/** Compute the public key (s*R - message*G)/r in Jacobian coordinates, given rn = 1/r. */
+static int secp256k1_ecdsa_sig_recover_mul(const secp256k1_ecmult_context *ctx, secp256k1_gej *qj, const secp256k1_ge *x, const secp256k1_scalar *rn, const secp256k1_scalar* sigs, const secp256k1_scalar *message) {
+    secp256k1_gej xj;
+    secp256k1_scalar u1, u2;
+
+    secp256k1_gej_set_ge(&xj, x);
+    secp256k1_scalar_mul(&u1, rn, message);
+    secp256k1_scalar_negate(&u1, &u1);
+    secp256k1_scalar_mul(&u2, rn, sigs);
+    secp256k1_ecmult(ctx, qj, &xj, &u2, &u1);
+    return !secp256k1_gej_is_infinity(qj);
+}
+
+static int secp256k1_ecdsa_sig_recover(const secp256k1_ecmult_context *ctx, const secp256k1_scalar *sigr, const secp256k1_scalar* sigs, secp256k1_ge *pubkey, const secp256k1_scalar *message, int recid) {
+    secp256k1_ge x;
+    secp256k1_scalar rn;
+    secp256k1_gej qj;
+
+    if (!secp256k1_ecdsa_sig_recover_r(&x, sigr, sigs, recid)) {
         return 0;
     }
-    secp256k1_gej_set_ge(&xj, &x);
     secp256k1_scalar_inverse_var(&rn, sigr);
-    secp256k1_scalar_mul(&u1, &rn, message);
-    secp256k1_scalar_negate(&u1, &u1);
-    secp256k1_scalar_mul(&u2, &rn, sigs);
-    secp256k1_ecmult(ctx, &qj, &xj, &u2, &u1);
+    secp256k1_ecdsa_sig_recover_mul(ctx, &qj, &x, &rn, sigs, message);
     secp256k1_ge_set_gej_var(pubkey, &qj);
     return !secp256k1_gej_is_infinity(&qj);
 }
@@ -190,4 +204,200 @@ int secp256k1_ecdsa_recover(const secp256k1_context* ctx, secp256k1_pubkey *pubk
     }
 }
 
+#define SECP256K1_ECDSA_RECOVER_ITEM_SIZE (sizeof(secp256k1_ge) + 2 * sizeof(secp256k1_scalar) + sizeof(secp256k1_gej) + 2 * sizeof(secp256k1_fe) + sizeof(int))
+
+/** Recover a batch of len public keys, which must fit in the scratch space, sharing the
+ *  inversions. */
+static int secp256k1_ecdsa_recover_batch_single(const secp256k1_context* ctx, secp256k1_scratch *scratch, secp256k1_pubkey *pubkeys, const secp256k1_ecdsa_recoverable_signature * const *sigs, const unsigned char * const *msg32s, size_t len) {
+    secp256k1_ge *xs;
+    secp256k1_scalar *rs;
+    secp256k1_scalar *rns;
+    secp256k1_gej *qjs;
+    secp256k1_fe *zs;
+    secp256k1_fe *zis;
+    int *oks;
+    secp256k1_scalar s, m;
+    int recid;
+    size_t j;
+    int ret = 1;
+
+    if (!secp256k1_scratch_allocate_frame(scratch, len * SECP256K1_ECDSA_RECOVER_ITEM_SIZE, 7)) {
+        return 0;
+    }
+    xs = (secp256k1_ge*)secp256k1_scratch_alloc(scratch, len * sizeof(secp256k1_ge));
+    rs = (secp256k1_scalar*)secp256k1_scratch_alloc(scratch, len * sizeof(secp256k1_scalar));
+    rns = (secp256k1_scalar*)secp256k1_scratch_alloc(scratch, len * sizeof(secp256k1_scalar));
+    qjs = (secp256k1_gej*)secp256k1_scratch_alloc(scratch, len * sizeof(secp256k1_gej));
+    zs = (secp256k1_fe*)secp256k1_scratch_alloc(scratch, len * sizeof(secp256k1_fe));
+    zis = (secp256k1_fe*)secp256k1_scratch_alloc(scratch, len * sizeof(secp256k1_fe));
+    oks = (int*)secp256k1_scratch_alloc(scratch, len * sizeof(int));
+
+    /* Signatures that cannot be recovered take part in the inversions with a
+     * dummy value of 1. */
+    for (j = 0; j < len; j++) {
+        secp256k1_ecdsa_recoverable_signature_load(ctx, &rs[j], &s, &recid, sigs[j]);
+        VERIFY_CHECK(recid >= 0 && recid < 4);  /* should have been caught in parse_compact */
+        oks[j] = secp256k1_ecdsa_sig_recover_r(&xs[j], &rs[j], &s, recid);
+        if (!oks[j]) {
+            secp256k1_scalar_set_int(&rs[j], 1);
+        }
+    }
+    secp256k1_scalar_inverse_all_var(rns, rs, len);
+    for (j = 0; j < len; j++) {
+        secp256k1_fe_set_int(&zs[j], 1);
+        if (oks[j]) {
+            secp256k1_ecdsa_recoverable_signature_load(ctx, &rs[j], &s, &recid, sigs[j]);
+            secp256k1_scalar_set_b32(&m, msg32s[j], NULL);
+            oks[j] = secp256k1_ecdsa_sig_recover_mul(&ctx->ecmult_ctx, &qjs[j], &xs[j], &rns[j], &s, &m);
+            if (oks[j]) {
+                zs[j] = qjs[j].z;
+            }
+        }
+    }
+    secp256k1_fe_inv_all_var(zis, zs, len);
+    for (j = 0; j < len; j++) {
+        if (oks[j]) {
+            secp256k1_ge_set_gej_zinv(&xs[j], &qjs[j], &zis[j]);
+            secp256k1_pubkey_save(&pubkeys[j], &xs[j]);
+        } else {
+            memset(&pubkeys[j], 0, sizeof(pubkeys[j]));
+            ret = 0;
+        }
+    }
+
+    secp256k1_scratch_deallocate_frame(scratch);
+    return ret;
+}
+
+struct secp256k1_ecdsa_recover_worker {
+    const secp256k1_context *ctx;
+    secp256k1_scratch *scratch;
+    secp256k1_pubkey *pubkeys;
+    const secp256k1_ecdsa_recoverable_signature * const *sigs;
+    const unsigned char * const *msg32s;
+    size_t n;
+    size_t n_batches;
+    size_t batch_size;
+    size_t n_workers;
+    int ret;
+};
+
+/* Worker idx recovers the batches idx, idx + n_workers, idx + 2*n_workers, ... */
+static void secp256k1_ecdsa_recover_worker_job(void *job_data, size_t idx) {
+    struct secp256k1_ecdsa_recover_worker *worker = &((struct secp256k1_ecdsa_recover_worker *) job_data)[idx];
+    size_t i;
+
+    worker->ret = 1;
+    for (i = idx; i < worker->n_batches; i += worker->n_workers) {
+        size_t offset = worker->batch_size * i;
+        size_t len = worker->n - offset < worker->batch_size ? worker->n - offset : worker->batch_size;
+        worker->ret &= secp256k1_ecdsa_recover_batch_single(worker->ctx, worker->scratch, &worker->pubkeys[offset], &worker->sigs[offset], &worker->msg32s[offset], len);
+    }
+}
+
+/** Recover the public keys in scratch-sized batches. With an executor and more than one
+ *  scratch space, the batches are distributed over workers that each use their own. */
+static int secp256k1_ecdsa_recover_batch_internal(const secp256k1_context* ctx, const secp256k1_executor *executor, secp256k1_scratch **scratch, size_t n_scratch, secp256k1_pubkey *pubkeys, const secp256k1_ecdsa_recoverable_signature * const *sigs, const unsigned char * const *msg32s, size_t n) {
+    struct secp256k1_ecdsa_recover_worker *workers = NULL;
+    size_t n_workers = 1;
+    size_t batch_size = 0;
+    size_t n_batches;
+    size_t i;
+    int ret = 1;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(n == 0 || pubkeys != NULL);
+    ARG_CHECK(n == 0 || sigs != NULL);
+    ARG_CHECK(n == 0 || msg32s != NULL);
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(sigs[i] != NULL);
+        ARG_CHECK(msg32s[i] != NULL);
+    }
+    if (n == 0) {
+        return 1;
+    }
+
+    /* The worker states live in the first scratch space; every scratch space must be able
+     * to hold a batch after that. */
+    if (executor != NULL && n_scratch > 1 && n > 1 && secp256k1_scratch_allocate_frame(scratch[0], n_scratch * sizeof(*workers), 1)) {
+        workers = (struct secp256k1_ecdsa_recover_worker *) secp256k1_scratch_alloc(scratch[0], n_scratch * sizeof(*workers));
+        n_workers = n_scratch;
+    }
+    for (i = 0; i < n_workers; i++) {
+        size_t bs = secp256k1_scratch_max_allocation(scratch[i], 7) / SECP256K1_ECDSA_RECOVER_ITEM_SIZE;
+        if (i == 0 || bs < batch_size) {
+            batch_size = bs;
+        }
+    }
+    if (batch_size == 0) {
+        /* Not enough scratch space to share inversions; recover one key at a time. */
+        if (workers != NULL) {
+            secp256k1_scratch_deallocate_frame(scratch[0]);
+        }
+        for (i = 0; i < n; i++) {
+            ret &= secp256k1_ecdsa_recover(ctx, &pubkeys[i], sigs[i], msg32s[i]);
+        }
+        return ret;
+    }
+
+    /* There are at least as many batches as workers (unless there are fewer signatures
+     * than that), so that every worker gets something to do. */
+    n_batches = (n + batch_size - 1) / batch_size;
+    if (n_batches < n_workers) {
+        n_batches = n < n_workers ? n : n_workers;
+    }
+    batch_size = (n + n_batches - 1) / n_batches;
+    /* Rounding up the batch size may leave the last batches empty. */
+    n_batches = (n + batch_size - 1) / batch_size;
+
+    if (workers == NULL) {
+        for (i = 0; i < n_batches; i++) {
+            size_t len = n - i * batch_size < batch_size ? n - i * batch_size : batch_size;
+            ret &= secp256k1_ecdsa_recover_batch_single(ctx, scratch[0], &pubkeys[i * batch_size], &sigs[i * batch_size], &msg32s[i * batch_size], len);
+        }
+        return ret;
+    }
+
+    n_workers = n_batches < n_workers ? n_batches : n_workers;
+    for (i = 0; i < n_workers; i++) {
+        workers[i].ctx = ctx;
+        workers[i].scratch = scratch[i];
+        workers[i].pubkeys = pubkeys;
+        workers[i].sigs = sigs;
+        workers[i].msg32s = msg32s;
+        workers[i].n = n;
+        workers[i].n_batches = n_batches;
+        workers[i].batch_size = batch_size;
+        workers[i].n_workers = n_workers;
+    }
+    executor->run(secp256k1_ecdsa_recover_worker_job, workers, n_workers, executor->data);
+
+    for (i = 0; i < n_workers; i++) {
+        ret &= workers[i].ret;
+    }
+    secp256k1_scratch_deallocate_frame(scratch[0]);
+    return ret;
+}
+
+int secp256k1_ecdsa_recover_batch(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_pubkey *pubkeys, const secp256k1_ecdsa_recoverable_signature * const *sigs, const unsigned char * const *msg32s, size_t n) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(scratch != NULL);
+    return secp256k1_ecdsa_recover_batch_internal(ctx, NULL, &scratch, 1, pubkeys, sigs, msg32s, n);
+}
+
+int secp256k1_ecdsa_recover_batch_parallel(const secp256k1_context* ctx, secp256k1_executor_function executor, void *executor_data, secp256k1_scratch_space **scratches, size_t n_scratches, secp256k1_pubkey *pubkeys, const secp256k1_ecdsa_recoverable_signature * const *sigs, const unsigned char * const *msg32s, size_t n) {
+    secp256k1_executor exec;
+    size_t i;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(executor != NULL);
+    ARG_CHECK(scratches != NULL);
+    ARG_CHECK(n_scratches > 0);
+    for (i = 0; i < n_scratches; i++) {
+        ARG_CHECK(scratches[i] != NULL);
+    }
+    exec.run = executor;
+    exec.data = executor_data;
+    return secp256k1_ecdsa_recover_batch_internal(ctx, &exec, scratches, n_scratches, pubkeys, sigs, msg32s, n);
+}
+
 #endif /* SECP256K1_MODULE_RECOVERY_MAIN_H */
@@ -205,6 +205,134 @@ void test_ecdsa_recovery_end_to_end(void) {
           memcmp(&pubkey, &recpubkey, sizeof(pubkey)) != 0);
 }
 
+/* Runs the jobs one after another, in reverse order, and counts them. */
+static void recovery_executor_run(secp256k1_executor_job_function job, void *job_data, size_t n_jobs, void *data) {
+    size_t i;
+    *(size_t *)data += n_jobs;
+    for (i = n_jobs; i > 0; i--) {
+        job(job_data, i - 1);
+    }
+}
+
+void test_ecdsa_recovery_batch(void) {
+    secp256k1_ecdsa_recoverable_signature rsignature[8];
+    secp256k1_ecdsa_recoverable_signature good;
+    secp256k1_pubkey pubkey[8];
+    secp256k1_pubkey recpubkey[8];
+    secp256k1_pubkey recpubkey2;
+    unsigned char message[8][32];
+    const secp256k1_ecdsa_recoverable_signature *sigptr[8];
+    const unsigned char *msgptr[8];
+    unsigned char zeros[sizeof(secp256k1_pubkey)] = {0};
+    unsigned char sig[64];
+    secp256k1_scratch_space *scratch;
+    secp256k1_scratch_space *scratches[4];
+    size_t scratch_size;
+    size_t n = secp256k1_rand_int(8) + 1;
+    size_t n_scratch, n_jobs;
+    size_t i, bad;
+    int recid;
+    int32_t ecount = 0;
+
+    for (i = 0; i < n; i++) {
+        unsigned char privkey[32];
+        secp256k1_scalar key;
+        random_scalar_order_test(&key);
+        secp256k1_scalar_get_b32(privkey, &key);
+        secp256k1_rand256_test(message[i]);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey[i], privkey) == 1);
+        CHECK(secp256k1_ecdsa_sign_recoverable(ctx, &rsignature[i], message[i], privkey, NULL, NULL) == 1);
+        sigptr[i] = &rsignature[i];
+        msgptr[i] = message[i];
+    }
+
+    /* Exercise scratch spaces that hold no batch, part of the batch and all of it. */
+    scratch_size = secp256k1_rand_int(n * 300 + 1) + 7 * ALIGNMENT;
+    scratch = secp256k1_scratch_space_create(ctx, scratch_size);
+    CHECK(secp256k1_ecdsa_recover_batch(ctx, scratch, NULL, NULL, NULL, 0) == 1);
+    CHECK(secp256k1_ecdsa_recover_batch(ctx, scratch, recpubkey, sigptr, msgptr, n) == 1);
+    for (i = 0; i < n; i++) {
+        CHECK(memcmp(&pubkey[i], &recpubkey[i], sizeof(pubkey[i])) == 0);
+    }
+
+    /* A signature that cannot be recovered only clears its own key. Unrecoverable
+     * because of r = 0, or, for recovery ids 2 and 3, because of r + n >= p. */
+    bad = secp256k1_rand_int(n);
+    good = rsignature[bad];
+    CHECK(secp256k1_ecdsa_recoverable_signature_serialize_compact(ctx, sig, &recid, &rsignature[bad]) == 1);
+    if (secp256k1_rand_bits(1)) {
+        memset(sig, 0, 32);
+    } else {
+        memset(sig, 0xff, 31);
+        sig[0] = 0x80;
+        recid |= 2;
+    }
+    CHECK(secp256k1_ecdsa_recoverable_signature_parse_compact(ctx, &rsignature[bad], sig, recid) == 1);
+    CHECK(secp256k1_ecdsa_recover(ctx, &recpubkey2, &rsignature[bad], message[bad]) == 0);
+    CHECK(secp256k1_ecdsa_recover_batch(ctx, scratch, recpubkey, sigptr, msgptr, n) == 0);
+    for (i = 0; i < n; i++) {
+        if (i == bad) {
+            CHECK(memcmp(&recpubkey[i], zeros, sizeof(recpubkey[i])) == 0);
+        } else {
+            CHECK(memcmp(&pubkey[i], &recpubkey[i], sizeof(pubkey[i])) == 0);
+        }
+    }
+
+    /* The same through an executor, with up to four scratch spaces of which some may hold
+     * no batch. */
+    n_scratch = secp256k1_rand_int(4) + 1;
+    for (i = 0; i < n_scratch; i++) {
+        if (secp256k1_rand_bits(3)) {
+            scratch_size = (secp256k1_rand_int(n) + 1) * SECP256K1_ECDSA_RECOVER_ITEM_SIZE + 7 * ALIGNMENT;
+        } else {
+            scratch_size = secp256k1_rand_int(SECP256K1_ECDSA_RECOVER_ITEM_SIZE);
+        }
+        if (i == 0) {
+            scratch_size += 4 * sizeof(struct secp256k1_ecdsa_recover_worker) + ALIGNMENT;
+        }
+        scratches[i] = secp256k1_scratch_space_create(ctx, scratch_size);
+    }
+    n_jobs = 0;
+    memset(recpubkey, 0, sizeof(recpubkey));
+    CHECK(secp256k1_ecdsa_recover_batch_parallel(ctx, recovery_executor_run, &n_jobs, scratches, n_scratch, recpubkey, sigptr, msgptr, n) == 0);
+    CHECK(n_jobs <= n_scratch);
+    for (i = 0; i < n; i++) {
+        if (i == bad) {
+            CHECK(memcmp(&recpubkey[i], zeros, sizeof(recpubkey[i])) == 0);
+        } else {
+            CHECK(memcmp(&pubkey[i], &recpubkey[i], sizeof(pubkey[i])) == 0);
+        }
+    }
+    rsignature[bad] = good;
+    CHECK(secp256k1_ecdsa_recover_batch_parallel(ctx, recovery_executor_run, &n_jobs, scratches, n_scratch, recpubkey, sigptr, msgptr, n) == 1);
+    for (i = 0; i < n; i++) {
+        CHECK(memcmp(&pubkey[i], &recpubkey[i], sizeof(pubkey[i])) == 0);
+    }
+    CHECK(secp256k1_ecdsa_recover_batch_parallel(ctx, recovery_executor_run, &n_jobs, scratches, n_scratch, NULL, NULL, NULL, 0) == 1);
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ecdsa_recover_batch_parallel(ctx, NULL, &n_jobs, scratches, n_scratch, recpubkey, sigptr, msgptr, n) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdsa_recover_batch_parallel(ctx, recovery_executor_run, &n_jobs, NULL, n_scratch, recpubkey, sigptr, msgptr, n) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecdsa_recover_batch_parallel(ctx, recovery_executor_run, &n_jobs, scratches, 0, recpubkey, sigptr, msgptr, n) == 0);
+    CHECK(ecount == 3);
+    ecount = 0;
+    for (i = 0; i < n_scratch; i++) {
+        secp256k1_scratch_space_destroy(scratches[i]);
+    }
+
+    CHECK(secp256k1_ecdsa_recover_batch(ctx, NULL, recpubkey, sigptr, msgptr, n) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdsa_recover_batch(ctx, scratch, NULL, sigptr, msgptr, n) == 0);
+    CHECK(ecount == 2);
+    msgptr[bad] = NULL;
+    CHECK(secp256k1_ecdsa_recover_batch(ctx, scratch, recpubkey, sigptr, msgptr, n) == 0);
+    CHECK(ecount == 3);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_scratch_space_destroy(scratch);
+}
+
 /* Tests several edge cases. */
 void test_ecdsa_recovery_edge_cases(void) {
     const unsigned char msg32[32] = {
@@ -387,6 +515,9 @@ void run_recovery_tests(void) {
     for (i = 0; i < 64*count; i++) {
         test_ecdsa_recovery_end_to_end();
     }
+    for (i = 0; i < count; i++) {
+        test_ecdsa_recovery_batch();
+    }
     test_ecdsa_recovery_edge_cases();
 }
 
@@ -0,0 +1,230 @@
+/**********************************************************************
+ * Copyright (c) 2018 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef SECP256K1_MODULE_TABLEFILE_MAIN_H
+#define SECP256K1_MODULE_TABLEFILE_MAIN_H
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "include/secp256k1_tablefile.h"
+
+/* File layout: a header followed by the ecmult_gen table, the table of odd multiples of G
+ * and, with the endomorphism, the one of 2^128*G. The header consists of:
+ * - bytes 0..15: the magic string
+ * - bytes 16..19: the format version (big endian)
+ * - bytes 20..23: sizeof(secp256k1_ge_storage) (big endian)
+ * - bytes 24..27: the window size of the verification tables (big endian)
+ * - bytes 28..29: the number of blocks of the ecmult_gen comb (big endian)
+ * - byte 30: the number of teeth of the ecmult_gen comb
+ * - byte 31: 1 if the endomorphism table is present, 0 otherwise
+ * - bytes 32..63: the SHA256 of everything after the header
+ */
+#define SECP256K1_TABLEFILE_VERSION 2
+#define SECP256K1_TABLEFILE_HEADER_SIZE 64
+
+static const unsigned char secp256k1_tablefile_magic[16] = {
+    's', 'e', 'c', 'p', '2', '5', '6', 'k', '1', ' ', 't', 'a', 'b', 'l', 'e', 's'
+};
+
+#ifdef USE_ENDOMORPHISM
+#define SECP256K1_TABLEFILE_N_TABLES 2
+#else
+#define SECP256K1_TABLEFILE_N_TABLES 1
+#endif
+
+typedef struct {
+    secp256k1_refcount ref; /* must be the first member */
+    void *addr;
+    size_t len;
+} secp256k1_tablefile_mapping;
+
+static void secp256k1_tablefile_unmap(secp256k1_refcount *ref) {
+    secp256k1_tablefile_mapping *mapping = (secp256k1_tablefile_mapping*)ref;
+    munmap(mapping->addr, mapping->len);
+    free(mapping);
+}
+
+static void secp256k1_tablefile_write_be32(unsigned char *p, uint32_t x) {
+    p[0] = x >> 24;
+    p[1] = x >> 16;
+    p[2] = x >> 8;
+    p[3] = x;
+}
+
+static uint32_t secp256k1_tablefile_read_be32(const unsigned char *p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+/** Fill in everything but the checksum. */
+static void secp256k1_tablefile_header(unsigned char *header, int window_g) {
+    memset(header, 0, SECP256K1_TABLEFILE_HEADER_SIZE);
+    memcpy(header, secp256k1_tablefile_magic, sizeof(secp256k1_tablefile_magic));
+    secp256k1_tablefile_write_be32(header + 16, SECP256K1_TABLEFILE_VERSION);
+    secp256k1_tablefile_write_be32(header + 20, sizeof(secp256k1_ge_storage));
+    secp256k1_tablefile_write_be32(header + 24, window_g);
+    header[28] = COMB_BLOCKS >> 8;
+    header[29] = COMB_BLOCKS & 0xff;
+    header[30] = COMB_TEETH;
+    header[31] = SECP256K1_TABLEFILE_N_TABLES - 1;
+}
+
+static size_t secp256k1_tablefile_size(int window_g) {
+    return SECP256K1_TABLEFILE_HEADER_SIZE + sizeof(secp256k1_ge_storage) * COMB_BLOCKS * COMB_POINTS +
+           SECP256K1_TABLEFILE_N_TABLES * sizeof(secp256k1_ge_storage) * ECMULT_TABLE_SIZE(window_g);
+}
+
+int secp256k1_tablefile_write(const secp256k1_context* ctx, const char *path) {
+    unsigned char header[SECP256K1_TABLEFILE_HEADER_SIZE];
+    secp256k1_sha256 hash;
+    size_t table_size;
+    FILE *fp;
+    int ret;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    ARG_CHECK(path != NULL);
+
+    table_size = sizeof(secp256k1_ge_storage) * ECMULT_TABLE_SIZE(ctx->ecmult_ctx.window_g);
+    secp256k1_tablefile_header(header, ctx->ecmult_ctx.window_g);
+    secp256k1_sha256_initialize(&hash);
+    secp256k1_sha256_write(&hash, (const unsigned char*)ctx->ecmult_gen_ctx.prec, sizeof(*ctx->ecmult_gen_ctx.prec));
+    secp256k1_sha256_write(&hash, (const unsigned char*)ctx->ecmult_ctx.pre_g, table_size);
+#ifdef USE_ENDOMORPHISM
+    secp256k1_sha256_write(&hash, (const unsigned char*)ctx->ecmult_ctx.pre_g_128, table_size);
+#endif
+    secp256k1_sha256_finalize(&hash, header + 32);
+
+    fp = fopen(path, "wb");
+    if (fp == NULL) {
+        return 0;
+    }
+    ret = fwrite(header, sizeof(header), 1, fp) == 1 &&
+          fwrite(ctx->ecmult_gen_ctx.prec, sizeof(*ctx->ecmult_gen_ctx.prec), 1, fp) == 1 &&
+          fwrite(ctx->ecmult_ctx.pre_g, table_size, 1, fp) == 1;
+#ifdef USE_ENDOMORPHISM
+    ret = ret && fwrite(ctx->ecmult_ctx.pre_g_128, table_size, 1, fp) == 1;
+#endif
+    ret &= fclose(fp) == 0;
+    return ret;
+}
+
+/** Check that data is a table file this library can use, and return its window size. */
+static int secp256k1_tablefile_check(const unsigned char *data, size_t len, int *window_g) {
+    unsigned char header[SECP256K1_TABLEFILE_HEADER_SIZE];
+    unsigned char checksum[32];
+    secp256k1_sha256 hash;
+    secp256k1_ecmult_gen_context gen_ctx;
+    secp256k1_ge_storage s;
+    secp256k1_scalar one;
+    secp256k1_gej gj;
+    secp256k1_ge ge;
+    int window;
+    int ret;
+
+    if (len < SECP256K1_TABLEFILE_HEADER_SIZE) {
+        return 0;
+    }
+    window = secp256k1_tablefile_read_be32(data + 24);
+    if (window < WINDOW_G_MIN || window > WINDOW_G_MAX) {
+        return 0;
+    }
+    secp256k1_tablefile_header(header, window);
+    if (memcmp(data, header, 32) != 0 || len != secp256k1_tablefile_size(window)) {
+        return 0;
+    }
+    secp256k1_sha256_initialize(&hash);
+    secp256k1_sha256_write(&hash, data + SECP256K1_TABLEFILE_HEADER_SIZE, len - SECP256K1_TABLEFILE_HEADER_SIZE);
+    secp256k1_sha256_finalize(&hash, checksum);
+    if (memcmp(data + 32, checksum, 32) != 0) {
+        return 0;
+    }
+
+    /* The checksum only guards against corruption. Also check that the tables hold
+     * multiples of G in the representation this library uses. */
+    data += SECP256K1_TABLEFILE_HEADER_SIZE + sizeof(*gen_ctx.prec);
+    secp256k1_ge_to_storage(&s, &secp256k1_ge_const_g);
+    if (memcmp(data, &s, sizeof(s)) != 0) {
+        return 0;
+    }
+    secp256k1_ecmult_gen_context_init(&gen_ctx);
+    gen_ctx.prec = (secp256k1_ge_storage (*)[COMB_BLOCKS][COMB_POINTS])(data - sizeof(*gen_ctx.prec));
+    secp256k1_ecmult_gen_blind(&gen_ctx, NULL);
+    secp256k1_scalar_set_int(&one, 1);
+    secp256k1_ecmult_gen(&gen_ctx, &gj, &one);
+    secp256k1_ge_set_gej(&ge, &gj);
+    secp256k1_ge_to_storage(&s, &ge);
+    ret = memcmp(data, &s, sizeof(s)) == 0;
+    secp256k1_ecmult_gen_context_clear(&gen_ctx);
+
+    *window_g = window;
+    return ret;
+}
+
+secp256k1_context* secp256k1_context_create_from_tablefile(unsigned int flags, const char *path) {
+    secp256k1_context* ret;
+    secp256k1_tablefile_mapping *mapping;
+    struct stat st;
+    void *addr;
+    int window_g;
+    int fd;
+
+    ret = secp256k1_context_create(flags & ~(SECP256K1_FLAGS_BIT_CONTEXT_SIGN | SECP256K1_FLAGS_BIT_CONTEXT_VERIFY));
+    if (ret == NULL) {
+        return NULL;
+    }
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        secp256k1_context_destroy(ret);
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < SECP256K1_TABLEFILE_HEADER_SIZE ||
+        (addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+        close(fd);
+        secp256k1_context_destroy(ret);
+        return NULL;
+    }
+    close(fd);
+    if (!secp256k1_tablefile_check((const unsigned char*)addr, st.st_size, &window_g)) {
+        munmap(addr, st.st_size);
+        secp256k1_context_destroy(ret);
+        return NULL;
+    }
+
+    /* The mapping is owned by the parts of the context using it. */
+    mapping = (secp256k1_tablefile_mapping*)checked_malloc(&ret->error_callback, sizeof(secp256k1_tablefile_mapping));
+    mapping->ref.n = 0;
+    mapping->ref.destroy = secp256k1_tablefile_unmap;
+    mapping->addr = addr;
+    mapping->len = st.st_size;
+    addr = (unsigned char*)addr + SECP256K1_TABLEFILE_HEADER_SIZE;
+    if (flags & SECP256K1_FLAGS_BIT_CONTEXT_SIGN) {
+        ret->ecmult_gen_ctx.prec = (secp256k1_ge_storage (*)[COMB_BLOCKS][COMB_POINTS])addr;
+        ret->ecmult_gen_ctx.refcount = &mapping->ref;
+        mapping->ref.n++;
+        secp256k1_ecmult_gen_blind(&ret->ecmult_gen_ctx, NULL);
+    }
+    addr = (unsigned char*)addr + sizeof(*ret->ecmult_gen_ctx.prec);
+    if (flags & SECP256K1_FLAGS_BIT_CONTEXT_VERIFY) {
+        ret->ecmult_ctx.pre_g = (secp256k1_ge_storage (*)[])addr;
+#ifdef USE_ENDOMORPHISM
+        ret->ecmult_ctx.pre_g_128 = (secp256k1_ge_storage (*)[])((secp256k1_ge_storage*)addr + ECMULT_TABLE_SIZE(window_g));
+#endif
+        ret->ecmult_ctx.window_g = window_g;
+        ret->ecmult_ctx.refcount = &mapping->ref;
+        mapping->ref.n++;
+    }
+    if (mapping->ref.n == 0) {
+        secp256k1_tablefile_unmap(&mapping->ref);
+    }
+    return ret;
+}
+
+#endif /* SECP256K1_MODULE_TABLEFILE_MAIN_H */
@@ -0,0 +1,126 @@
+/**********************************************************************
+ * Copyright (c) 2018 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef SECP256K1_MODULE_TABLEFILE_TESTS_H
+#define SECP256K1_MODULE_TABLEFILE_TESTS_H
+
+#define TABLEFILE_TEST_PATH "secp256k1_tablefile_test.tmp"
+
+/* Flip one bit at offset pos in the test file. */
+static void tablefile_flip_bit(long pos) {
+    FILE *fp = fopen(TABLEFILE_TEST_PATH, "r+b");
+    int c;
+    CHECK(fp != NULL);
+    CHECK(fseek(fp, pos, SEEK_SET) == 0);
+    c = fgetc(fp);
+    CHECK(c != EOF);
+    CHECK(fseek(fp, pos, SEEK_SET) == 0);
+    CHECK(fputc(c ^ 1, fp) != EOF);
+    CHECK(fclose(fp) == 0);
+}
+
+/* Cut the test file down to its first len bytes. */
+static void tablefile_truncate(size_t len) {
+    unsigned char *data = (unsigned char*)checked_malloc(&ctx->error_callback, len + 1);
+    FILE *fp = fopen(TABLEFILE_TEST_PATH, "rb");
+    CHECK(fp != NULL);
+    CHECK(fread(data, 1, len, fp) == len);
+    CHECK(fclose(fp) == 0);
+    fp = fopen(TABLEFILE_TEST_PATH, "wb");
+    CHECK(fp != NULL);
+    CHECK(fwrite(data, 1, len, fp) == len);
+    CHECK(fclose(fp) == 0);
+    free(data);
+}
+
+void test_tablefile_api(void) {
+    secp256k1_context *none = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    secp256k1_context *vrfy = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+    secp256k1_context *both = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
+    int32_t ecount = 0;
+
+    secp256k1_context_set_illegal_callback(none, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(vrfy, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(both, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_tablefile_write(none, TABLEFILE_TEST_PATH) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_tablefile_write(vrfy, TABLEFILE_TEST_PATH) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_tablefile_write(both, NULL) == 0);
+    CHECK(ecount == 3);
+
+    CHECK(secp256k1_context_create_from_tablefile(SECP256K1_CONTEXT_VERIFY, "nonexistent/" TABLEFILE_TEST_PATH) == NULL);
+
+    secp256k1_context_destroy(none);
+    secp256k1_context_destroy(vrfy);
+    secp256k1_context_destroy(both);
+}
+
+void test_tablefile_load(unsigned int flags) {
+    secp256k1_context *loaded = secp256k1_context_create_from_tablefile(flags, TABLEFILE_TEST_PATH);
+    secp256k1_context *copy;
+    secp256k1_ecdsa_signature sig;
+    secp256k1_pubkey pubkey;
+    unsigned char seckey[32];
+    unsigned char msg[32];
+    secp256k1_scalar key;
+
+    CHECK(loaded != NULL);
+    CHECK(secp256k1_ecmult_gen_context_is_built(&loaded->ecmult_gen_ctx) == !!(flags & SECP256K1_FLAGS_BIT_CONTEXT_SIGN));
+    CHECK(secp256k1_ecmult_context_is_built(&loaded->ecmult_ctx) == !!(flags & SECP256K1_FLAGS_BIT_CONTEXT_VERIFY));
+    copy = secp256k1_context_clone(loaded);
+    secp256k1_context_destroy(loaded);
+
+    random_scalar_order_test(&key);
+    secp256k1_scalar_get_b32(seckey, &key);
+    secp256k1_rand256_test(msg);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, seckey) == 1);
+    if (flags & SECP256K1_FLAGS_BIT_CONTEXT_SIGN) {
+        secp256k1_pubkey pubkey2;
+        CHECK(memcmp(copy->ecmult_gen_ctx.prec, ctx->ecmult_gen_ctx.prec, sizeof(*ctx->ecmult_gen_ctx.prec)) == 0);
+        CHECK(secp256k1_ec_pubkey_create(copy, &pubkey2, seckey) == 1);
+        CHECK(memcmp(&pubkey, &pubkey2, sizeof(pubkey)) == 0);
+        CHECK(secp256k1_ecdsa_sign(copy, &sig, msg, seckey, NULL, NULL) == 1);
+    } else {
+        CHECK(secp256k1_ecdsa_sign(ctx, &sig, msg, seckey, NULL, NULL) == 1);
+    }
+    CHECK(secp256k1_ecdsa_verify(ctx, &sig, msg, &pubkey) == 1);
+    if (flags & SECP256K1_FLAGS_BIT_CONTEXT_VERIFY) {
+        CHECK(copy->ecmult_ctx.window_g == ctx->ecmult_ctx.window_g);
+        CHECK(secp256k1_ecdsa_verify(copy, &sig, msg, &pubkey) == 1);
+        msg[0] ^= 1;
+        CHECK(secp256k1_ecdsa_verify(copy, &sig, msg, &pubkey) == 0);
+    }
+    secp256k1_context_destroy(copy);
+}
+
+void run_tablefile_tests(void) {
+    size_t size = secp256k1_tablefile_size(ctx->ecmult_ctx.window_g);
+
+    test_tablefile_api();
+
+    CHECK(secp256k1_tablefile_write(ctx, TABLEFILE_TEST_PATH) == 1);
+    test_tablefile_load(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
+    test_tablefile_load(SECP256K1_CONTEXT_SIGN);
+    test_tablefile_load(SECP256K1_CONTEXT_VERIFY);
+    test_tablefile_load(SECP256K1_CONTEXT_NONE);
+
+    /* Any corruption of the header or the tables is detected. */
+    tablefile_flip_bit(secp256k1_rand_int(SECP256K1_TABLEFILE_HEADER_SIZE));
+    CHECK(secp256k1_context_create_from_tablefile(SECP256K1_CONTEXT_VERIFY, TABLEFILE_TEST_PATH) == NULL);
+    CHECK(secp256k1_tablefile_write(ctx, TABLEFILE_TEST_PATH) == 1);
+    tablefile_flip_bit(SECP256K1_TABLEFILE_HEADER_SIZE + secp256k1_rand_int(size - SECP256K1_TABLEFILE_HEADER_SIZE));
+    CHECK(secp256k1_context_create_from_tablefile(SECP256K1_CONTEXT_VERIFY, TABLEFILE_TEST_PATH) == NULL);
+
+    /* So is a truncated file. */
+    CHECK(secp256k1_tablefile_write(ctx, TABLEFILE_TEST_PATH) == 1);
+    tablefile_truncate(secp256k1_rand_int(size));
+    CHECK(secp256k1_context_create_from_tablefile(SECP256K1_CONTEXT_VERIFY, TABLEFILE_TEST_PATH) == NULL);
+
+    CHECK(remove(TABLEFILE_TEST_PATH) == 0);
+}
+
+#endif /* SECP256K1_MODULE_TABLEFILE_TESTS_H */
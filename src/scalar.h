@@ -63,6 +63,15 @@ static void secp256k1_scalar_inverse(secp256k1_scalar *r, const secp256k1_scalar
 /** Compute the inverse of a scalar (modulo the group order), without constant-time guarantee. */
 static void secp256k1_scalar_inverse_var(secp256k1_scalar *r, const secp256k1_scalar *a);
 
+/** Compute the inverses of len non-zero scalars (modulo the group order), without constant-time
+ *  guarantee, using a single inversion. r and a must not overlap. */
+static void secp256k1_scalar_inverse_all_var(secp256k1_scalar *r, const secp256k1_scalar *a, size_t len);
+
+/** Compute the inverses of len non-zero scalars (modulo the group order) in constant time, using
+ *  a single inversion. The product of the inputs is multiplied by the non-zero scalar blind
+ *  before it is inverted. r and a must not overlap. */
+static void secp256k1_scalar_inverse_all(secp256k1_scalar *r, const secp256k1_scalar *a, size_t len, const secp256k1_scalar *blind);
+
 /** Compute the complement of a scalar (modulo the group order). */
 static void secp256k1_scalar_negate(secp256k1_scalar *r, const secp256k1_scalar *a);
 
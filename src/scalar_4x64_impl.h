@@ -7,6 +7,14 @@
 #ifndef SECP256K1_SCALAR_REPR_IMPL_H
 #define SECP256K1_SCALAR_REPR_IMPL_H
 
+#if defined(USE_SCALAR_INV_SAFEGCD)
+#include "modinv64_impl.h"
+#endif
+
+#if defined(USE_RUNTIME_DISPATCH)
+#include "dispatch_impl.h"
+#endif
+
 /* Limbs of the secp256k1 order. */
 #define SECP256K1_N_0 ((uint64_t)0xBFD25E8CD0364141ULL)
 #define SECP256K1_N_1 ((uint64_t)0xBAAEDCE6AF48A03BULL)
@@ -576,8 +584,8 @@ static void secp256k1_scalar_reduce_512(secp256k1_scalar *r, const uint64_t *l)
     secp256k1_scalar_reduce(r, c + secp256k1_scalar_check_overflow(r));
 }
 
-static void secp256k1_scalar_mul_512(uint64_t l[8], const secp256k1_scalar *a, const secp256k1_scalar *b) {
 #ifdef USE_ASM_X86_64
+static void secp256k1_scalar_mul_512_x86_64(uint64_t l[8], const secp256k1_scalar *a, const secp256k1_scalar *b) {
     const uint64_t *pb = b->d;
     __asm__ __volatile__(
     /* Preload */
@@ -709,7 +717,11 @@ static void secp256k1_scalar_mul_512(uint64_t l[8], const secp256k1_scalar *a, c
     : "+d"(pb)
     : "S"(l), "D"(a->d)
     : "rax", "rbx", "rcx", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15", "cc", "memory");
-#else
+}
+#endif
+
+#if !defined(USE_ASM_X86_64) || defined(USE_RUNTIME_DISPATCH)
+static void secp256k1_scalar_mul_512_generic(uint64_t l[8], const secp256k1_scalar *a, const secp256k1_scalar *b) {
     /* 160 bit accumulator. */
     uint64_t c0 = 0, c1 = 0;
     uint32_t c2 = 0;
@@ -740,11 +752,94 @@ static void secp256k1_scalar_mul_512(uint64_t l[8], const secp256k1_scalar *a, c
     extract_fast(l[6]);
     VERIFY_CHECK(c1 == 0);
     l[7] = c0;
+}
 #endif
+
+#ifdef USE_RUNTIME_DISPATCH
+/* The schoolbook product row by row, as in secp256k1_scalar_mul_512_x86_64, but with mulx, which
+ * leaves the flags alone, so that the low and high halves of each row are added through two
+ * independent carry chains (adcx on CF, adox on OF). Requires BMI2 and ADX. */
+static void secp256k1_scalar_mul_512_bmi2(uint64_t l[8], const secp256k1_scalar *a, const secp256k1_scalar *b) {
+    __asm__ __volatile__(
+    /* (l0..l4) = a0 * b */
+    "movq 0(%%rdi), %%rdx\n"
+    "mulxq 0(%%rcx), %%r8, %%r9\n"
+    "mulxq 8(%%rcx), %%rax, %%r10\n"
+    "addq %%rax, %%r9\n"
+    "mulxq 16(%%rcx), %%rax, %%r11\n"
+    "adcq %%rax, %%r10\n"
+    "mulxq 24(%%rcx), %%rax, %%r12\n"
+    "adcq %%rax, %%r11\n"
+    "adcq $0, %%r12\n"
+    /* Extract l0 */
+    "movq %%r8, 0(%%rsi)\n"
+    /* (l1..l5) += a1 * b, low halves through CF, high halves through OF */
+    "movq 8(%%rdi), %%rdx\n"
+    "xorl %%r13d, %%r13d\n"
+    "mulxq 0(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r9\n"
+    "adoxq %%rbx, %%r10\n"
+    "mulxq 8(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r10\n"
+    "adoxq %%rbx, %%r11\n"
+    "mulxq 16(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r11\n"
+    "adoxq %%rbx, %%r12\n"
+    "mulxq 24(%%rcx), %%rax, %%r8\n"
+    "adcxq %%rax, %%r12\n"
+    "adcxq %%r13, %%r8\n"
+    "adoxq %%r13, %%r8\n"
+    /* Extract l1 */
+    "movq %%r9, 8(%%rsi)\n"
+    /* (l2..l6) += a2 * b, low halves through CF, high halves through OF */
+    "movq 16(%%rdi), %%rdx\n"
+    "xorl %%r13d, %%r13d\n"
+    "mulxq 0(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r10\n"
+    "adoxq %%rbx, %%r11\n"
+    "mulxq 8(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r11\n"
+    "adoxq %%rbx, %%r12\n"
+    "mulxq 16(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r12\n"
+    "adoxq %%rbx, %%r8\n"
+    "mulxq 24(%%rcx), %%rax, %%r9\n"
+    "adcxq %%rax, %%r8\n"
+    "adcxq %%r13, %%r9\n"
+    "adoxq %%r13, %%r9\n"
+    /* Extract l2 */
+    "movq %%r10, 16(%%rsi)\n"
+    /* (l3..l7) += a3 * b, low halves through CF, high halves through OF */
+    "movq 24(%%rdi), %%rdx\n"
+    "xorl %%r13d, %%r13d\n"
+    "mulxq 0(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r11\n"
+    "adoxq %%rbx, %%r12\n"
+    "mulxq 8(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r12\n"
+    "adoxq %%rbx, %%r8\n"
+    "mulxq 16(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r8\n"
+    "adoxq %%rbx, %%r9\n"
+    "mulxq 24(%%rcx), %%rax, %%r10\n"
+    "adcxq %%rax, %%r9\n"
+    "adcxq %%r13, %%r10\n"
+    "adoxq %%r13, %%r10\n"
+    /* Extract l3 */
+    "movq %%r11, 24(%%rsi)\n"
+    /* Extract l4..l7 */
+    "movq %%r12, 32(%%rsi)\n"
+    "movq %%r8, 40(%%rsi)\n"
+    "movq %%r9, 48(%%rsi)\n"
+    "movq %%r10, 56(%%rsi)\n"
+    :
+    : "S"(l), "D"(a->d), "c"(b->d)
+    : "rax", "rbx", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "cc", "memory");
 }
+#endif
 
-static void secp256k1_scalar_sqr_512(uint64_t l[8], const secp256k1_scalar *a) {
 #ifdef USE_ASM_X86_64
+static void secp256k1_scalar_sqr_512_x86_64(uint64_t l[8], const secp256k1_scalar *a) {
     __asm__ __volatile__(
     /* Preload */
     "movq 0(%%rdi), %%r11\n"
@@ -852,7 +947,11 @@ static void secp256k1_scalar_sqr_512(uint64_t l[8], const secp256k1_scalar *a) {
     :
     : "S"(l), "D"(a->d)
     : "rax", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "cc", "memory");
-#else
+}
+#endif
+
+#if !defined(USE_ASM_X86_64) || defined(USE_RUNTIME_DISPATCH)
+static void secp256k1_scalar_sqr_512_generic(uint64_t l[8], const secp256k1_scalar *a) {
     /* 160 bit accumulator. */
     uint64_t c0 = 0, c1 = 0;
     uint32_t c2 = 0;
@@ -877,8 +976,8 @@ static void secp256k1_scalar_sqr_512(uint64_t l[8], const secp256k1_scalar *a) {
     extract_fast(l[6]);
     VERIFY_CHECK(c1 == 0);
     l[7] = c0;
-#endif
 }
+#endif
 
 #undef sumadd
 #undef sumadd_fast
@@ -888,6 +987,38 @@ static void secp256k1_scalar_sqr_512(uint64_t l[8], const secp256k1_scalar *a) {
 #undef extract
 #undef extract_fast
 
+static void secp256k1_scalar_mul_512(uint64_t l[8], const secp256k1_scalar *a, const secp256k1_scalar *b) {
+#if defined(USE_RUNTIME_DISPATCH)
+    int kernel = secp256k1_kernel_get();
+    if (kernel == SECP256K1_KERNEL_BMI2) {
+        secp256k1_scalar_mul_512_bmi2(l, a, b);
+    } else if (kernel == SECP256K1_KERNEL_X86_64) {
+        secp256k1_scalar_mul_512_x86_64(l, a, b);
+    } else {
+        secp256k1_scalar_mul_512_generic(l, a, b);
+    }
+#elif defined(USE_ASM_X86_64)
+    secp256k1_scalar_mul_512_x86_64(l, a, b);
+#else
+    secp256k1_scalar_mul_512_generic(l, a, b);
+#endif
+}
+
+static void secp256k1_scalar_sqr_512(uint64_t l[8], const secp256k1_scalar *a) {
+#if defined(USE_RUNTIME_DISPATCH)
+    /* There is no BMI2 squaring; the x86_64 one serves both assembly kernels. */
+    if (secp256k1_kernel_get() != SECP256K1_KERNEL_GENERIC) {
+        secp256k1_scalar_sqr_512_x86_64(l, a);
+    } else {
+        secp256k1_scalar_sqr_512_generic(l, a);
+    }
+#elif defined(USE_ASM_X86_64)
+    secp256k1_scalar_sqr_512_x86_64(l, a);
+#else
+    secp256k1_scalar_sqr_512_generic(l, a);
+#endif
+}
+
 static void secp256k1_scalar_mul(secp256k1_scalar *r, const secp256k1_scalar *a, const secp256k1_scalar *b) {
     uint64_t l[8];
     secp256k1_scalar_mul_512(l, a, b);
@@ -946,4 +1077,60 @@ SECP256K1_INLINE static void secp256k1_scalar_mul_shift_var(secp256k1_scalar *r,
     secp256k1_scalar_cadd_bit(r, 0, (l[(shift - 1) >> 6] >> ((shift - 1) & 0x3f)) & 1);
 }
 
+#if defined(USE_SCALAR_INV_SAFEGCD)
+static void secp256k1_scalar_from_signed62(secp256k1_scalar *r, const secp256k1_modinv64_signed62 *a) {
+    const uint64_t a0 = a->v[0], a1 = a->v[1], a2 = a->v[2], a3 = a->v[3], a4 = a->v[4];
+
+    /* The output from secp256k1_modinv64{_var} is normalized to range [0,modulus), and has limbs
+     * in [0,2^62). The modulus is < 2^256, so the top limb must be below 2^(256-62*4). */
+    VERIFY_CHECK(a0 >> 62 == 0);
+    VERIFY_CHECK(a1 >> 62 == 0);
+    VERIFY_CHECK(a2 >> 62 == 0);
+    VERIFY_CHECK(a3 >> 62 == 0);
+    VERIFY_CHECK(a4 >> 8 == 0);
+
+    r->d[0] = a0      | a1 << 62;
+    r->d[1] = a1 >> 2 | a2 << 60;
+    r->d[2] = a2 >> 4 | a3 << 58;
+    r->d[3] = a3 >> 6 | a4 << 56;
+
+    VERIFY_CHECK(secp256k1_scalar_check_overflow(r) == 0);
+}
+
+static void secp256k1_scalar_to_signed62(secp256k1_modinv64_signed62 *r, const secp256k1_scalar *a) {
+    const uint64_t M62 = UINT64_MAX >> 2;
+    const uint64_t a0 = a->d[0], a1 = a->d[1], a2 = a->d[2], a3 = a->d[3];
+
+    VERIFY_CHECK(secp256k1_scalar_check_overflow(a) == 0);
+
+    r->v[0] =  a0                   & M62;
+    r->v[1] = (a0 >> 62 | a1 <<  2) & M62;
+    r->v[2] = (a1 >> 60 | a2 <<  4) & M62;
+    r->v[3] = (a2 >> 58 | a3 <<  6) & M62;
+    r->v[4] =  a3 >> 56;
+}
+
+/* The group order in signed62, and its inverse mod 2^62. */
+static const secp256k1_modinv64_modinfo secp256k1_const_modinfo_scalar = {
+    {{-0x2DA1732FC9BEBFLL, -0x15448C6542DD7F11LL, -0x14LL, 0, 256}},
+    0x34F20099AA774EC1ULL
+};
+
+static void secp256k1_scalar_inverse(secp256k1_scalar *r, const secp256k1_scalar *x) {
+    secp256k1_modinv64_signed62 s;
+
+    secp256k1_scalar_to_signed62(&s, x);
+    secp256k1_modinv64(&s, &secp256k1_const_modinfo_scalar);
+    secp256k1_scalar_from_signed62(r, &s);
+}
+
+static void secp256k1_scalar_inverse_var(secp256k1_scalar *r, const secp256k1_scalar *x) {
+    secp256k1_modinv64_signed62 s;
+
+    secp256k1_scalar_to_signed62(&s, x);
+    secp256k1_modinv64_var(&s, &secp256k1_const_modinfo_scalar);
+    secp256k1_scalar_from_signed62(r, &s);
+}
+#endif
+
 #endif /* SECP256K1_SCALAR_REPR_IMPL_H */
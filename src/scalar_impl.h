@@ -52,6 +52,9 @@ static void secp256k1_scalar_order_get_num(secp256k1_num *r) {
 }
 #endif
 
+/* With safegcd, the 4x64 and 8x32 representations implement the inverses themselves (but the
+ * small orders of the exhaustive tests still use the code below). */
+#if !defined(USE_SCALAR_INV_SAFEGCD) || defined(EXHAUSTIVE_TEST_ORDER)
 static void secp256k1_scalar_inverse(secp256k1_scalar *r, const secp256k1_scalar *x) {
 #if defined(EXHAUSTIVE_TEST_ORDER)
     int i;
@@ -216,14 +219,10 @@ static void secp256k1_scalar_inverse(secp256k1_scalar *r, const secp256k1_scalar
     }
     secp256k1_scalar_mul(r, t, &x6); /* 111111 */
 }
-
-SECP256K1_INLINE static int secp256k1_scalar_is_even(const secp256k1_scalar *a) {
-    return !(a->d[0] & 1);
-}
 #endif
 
 static void secp256k1_scalar_inverse_var(secp256k1_scalar *r, const secp256k1_scalar *x) {
-#if defined(USE_SCALAR_INV_BUILTIN)
+#if defined(USE_SCALAR_INV_BUILTIN) || defined(USE_SCALAR_INV_SAFEGCD)
     secp256k1_scalar_inverse(r, x);
 #elif defined(USE_SCALAR_INV_NUM)
     unsigned char b[32];
@@ -242,6 +241,69 @@ static void secp256k1_scalar_inverse_var(secp256k1_scalar *r, const secp256k1_sc
 #error "Please select scalar inverse implementation"
 #endif
 }
+#endif
+
+#if !defined(EXHAUSTIVE_TEST_ORDER)
+SECP256K1_INLINE static int secp256k1_scalar_is_even(const secp256k1_scalar *a) {
+    return !(a->d[0] & 1);
+}
+#endif
+
+static void secp256k1_scalar_inverse_all_var(secp256k1_scalar *r, const secp256k1_scalar *a, size_t len) {
+    secp256k1_scalar u;
+    size_t i;
+    if (len < 1) {
+        return;
+    }
+
+    VERIFY_CHECK((r + len <= a) || (a + len <= r));
+
+    r[0] = a[0];
+
+    i = 0;
+    while (++i < len) {
+        secp256k1_scalar_mul(&r[i], &r[i - 1], &a[i]);
+    }
+
+    secp256k1_scalar_inverse_var(&u, &r[--i]);
+
+    while (i > 0) {
+        size_t j = i--;
+        secp256k1_scalar_mul(&r[j], &r[i], &u);
+        secp256k1_scalar_mul(&u, &u, &a[j]);
+    }
+
+    r[0] = u;
+}
+
+static void secp256k1_scalar_inverse_all(secp256k1_scalar *r, const secp256k1_scalar *a, size_t len, const secp256k1_scalar *blind) {
+    secp256k1_scalar u;
+    size_t i;
+    if (len < 1) {
+        return;
+    }
+
+    VERIFY_CHECK((r + len <= a) || (a + len <= r));
+    VERIFY_CHECK(!secp256k1_scalar_is_zero(blind));
+
+    r[0] = a[0];
+    for (i = 1; i < len; i++) {
+        secp256k1_scalar_mul(&r[i], &r[i - 1], &a[i]);
+    }
+
+    /* Invert blind*product instead of the product itself, and multiply the blinding back in. */
+    secp256k1_scalar_mul(&u, &r[len - 1], blind);
+    secp256k1_scalar_inverse(&u, &u);
+    secp256k1_scalar_mul(&u, &u, blind);
+
+    for (i = len - 1; i > 0; i--) {
+        secp256k1_scalar_mul(&r[i], &r[i - 1], &u);
+        secp256k1_scalar_mul(&u, &u, &a[i]);
+    }
+
+    r[0] = u;
+    secp256k1_scalar_clear(&u);
+}
 
 #ifdef USE_ENDOMORPHISM
 #if defined(EXHAUSTIVE_TEST_ORDER)
@@ -7,6 +7,7 @@
 #include "include/secp256k1.h"
 
 #include "util.h"
+#include "dispatch_impl.h"
 #include "num_impl.h"
 #include "field_impl.h"
 #include "scalar_impl.h"
@@ -57,7 +58,13 @@ struct secp256k1_context_struct {
 };
 
 secp256k1_context* secp256k1_context_create(unsigned int flags) {
-    secp256k1_context* ret = (secp256k1_context*)checked_malloc(&default_error_callback, sizeof(secp256k1_context));
+    return secp256k1_context_create_with_window(flags, WINDOW_G);
+}
+
+secp256k1_context* secp256k1_context_create_with_window(unsigned int flags, int window) {
+    secp256k1_context* ret;
+    secp256k1_kernel_select();
+    ret = (secp256k1_context*)checked_malloc(&default_error_callback, sizeof(secp256k1_context));
     ret->illegal_callback = default_illegal_callback;
     ret->error_callback = default_error_callback;
 
@@ -67,6 +74,12 @@ secp256k1_context* secp256k1_context_create(unsigned int flags) {
             free(ret);
             return NULL;
     }
+    if (EXPECT(window < WINDOW_G_MIN || window > WINDOW_G_MAX, 0)) {
+            secp256k1_callback_call(&ret->illegal_callback,
+                                    "Invalid window");
+            free(ret);
+            return NULL;
+    }
 
     secp256k1_ecmult_context_init(&ret->ecmult_ctx);
     secp256k1_ecmult_gen_context_init(&ret->ecmult_gen_ctx);
@@ -75,7 +88,7 @@ secp256k1_context* secp256k1_context_create(unsigned int flags) {
         secp256k1_ecmult_gen_context_build(&ret->ecmult_gen_ctx, &ret->error_callback);
     }
     if (flags & SECP256K1_FLAGS_BIT_CONTEXT_VERIFY) {
-        secp256k1_ecmult_context_build(&ret->ecmult_ctx, &ret->error_callback);
+        secp256k1_ecmult_context_build(&ret->ecmult_ctx, window, &ret->error_callback);
     }
 
     return ret;
@@ -115,6 +128,12 @@ void secp256k1_context_set_error_callback(secp256k1_context* ctx, void (*fun)(co
     ctx->error_callback.data = data;
 }
 
+const char* secp256k1_context_get_kernel(const secp256k1_context* ctx) {
+    VERIFY_CHECK(ctx != NULL);
+    (void)ctx;
+    return secp256k1_kernel_name(secp256k1_kernel_get());
+}
+
 secp256k1_scratch_space* secp256k1_scratch_space_create(const secp256k1_context* ctx, size_t max_size) {
     VERIFY_CHECK(ctx != NULL);
     return secp256k1_scratch_create(&ctx->error_callback, max_size);
@@ -317,6 +336,107 @@ int secp256k1_ecdsa_verify(const secp256k1_context* ctx, const secp256k1_ecdsa_s
             secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &r, &s, &q, &m));
 }
 
+struct secp256k1_pubkey_precomp_struct {
+    secp256k1_ecmult_point_table table;
+};
+
+secp256k1_pubkey_precomp* secp256k1_pubkey_precomp_create(const secp256k1_context* ctx, const secp256k1_pubkey *pubkey) {
+    secp256k1_pubkey_precomp* ret;
+    secp256k1_ge q;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(pubkey != NULL);
+
+    if (!secp256k1_pubkey_load(ctx, &q, pubkey)) {
+        return NULL;
+    }
+    ret = (secp256k1_pubkey_precomp*)checked_malloc(&ctx->error_callback, sizeof(secp256k1_pubkey_precomp));
+    secp256k1_ecmult_point_table_init(&ret->table);
+    secp256k1_ecmult_point_table_build(&ret->table, &q, &ctx->error_callback);
+    return ret;
+}
+
+void secp256k1_pubkey_precomp_destroy(secp256k1_pubkey_precomp* precomp) {
+    if (precomp != NULL) {
+        secp256k1_ecmult_point_table_clear(&precomp->table);
+        free(precomp);
+    }
+}
+
+int secp256k1_ecdsa_verify_precomp(const secp256k1_context* ctx, const secp256k1_ecdsa_signature *sig, const unsigned char *msg32, const secp256k1_pubkey_precomp *precomp) {
+    secp256k1_scalar r, s;
+    secp256k1_scalar m;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(msg32 != NULL);
+    ARG_CHECK(sig != NULL);
+    ARG_CHECK(precomp != NULL);
+
+    secp256k1_scalar_set_b32(&m, msg32, NULL);
+    secp256k1_ecdsa_signature_load(ctx, &r, &s, sig);
+    return (!secp256k1_scalar_is_high(&s) &&
+            secp256k1_ecdsa_sig_verify_table(&ctx->ecmult_ctx, &r, &s, &precomp->table, &m));
+}
+
+int secp256k1_ecdsa_verify_batch(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, const secp256k1_ecdsa_signature * const *sigs, const unsigned char * const *msg32s, const secp256k1_pubkey * const *pubkeys, size_t n) {
+    secp256k1_ge q;
+    secp256k1_scalar r, s;
+    secp256k1_scalar m;
+    secp256k1_scalar *ss;
+    secp256k1_scalar *sns;
+    size_t batch_size;
+    size_t i, j;
+    int ret = 1;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(scratch != NULL);
+    ARG_CHECK(n == 0 || sigs != NULL);
+    ARG_CHECK(n == 0 || msg32s != NULL);
+    ARG_CHECK(n == 0 || pubkeys != NULL);
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(sigs[i] != NULL);
+        ARG_CHECK(msg32s[i] != NULL);
+        ARG_CHECK(pubkeys[i] != NULL);
+    }
+
+    /* The s values of a batch and their inverses live in the scratch space, so that a
+     * single modular inversion is shared by the whole batch. */
+    batch_size = secp256k1_scratch_max_allocation(scratch, 2) / (2 * sizeof(secp256k1_scalar));
+    if (batch_size > n) {
+        batch_size = n;
+    }
+    if (batch_size == 0 || !secp256k1_scratch_allocate_frame(scratch, 2 * batch_size * sizeof(secp256k1_scalar), 2)) {
+        /* Not enough scratch space to share inversions; verify one signature at a time. */
+        for (i = 0; i < n; i++) {
+            if (!secp256k1_ecdsa_verify(ctx, sigs[i], msg32s[i], pubkeys[i])) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+    ss = (secp256k1_scalar*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_scalar));
+    sns = (secp256k1_scalar*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_scalar));
+
+    for (i = 0; ret && i < n; i += batch_size) {
+        size_t len = n - i < batch_size ? n - i : batch_size;
+        for (j = 0; ret && j < len; j++) {
+            secp256k1_ecdsa_signature_load(ctx, &r, &ss[j], sigs[i + j]);
+            ret = !secp256k1_scalar_is_zero(&ss[j]) && !secp256k1_scalar_is_high(&ss[j]);
+        }
+        if (ret) {
+            secp256k1_scalar_inverse_all_var(sns, ss, len);
+        }
+        for (j = 0; ret && j < len; j++) {
+            secp256k1_ecdsa_signature_load(ctx, &r, &s, sigs[i + j]);
+            secp256k1_scalar_set_b32(&m, msg32s[i + j], NULL);
+            ret = secp256k1_pubkey_load(ctx, &q, pubkeys[i + j]) &&
+                  secp256k1_ecdsa_sig_verify_sinv(&ctx->ecmult_ctx, &r, &sns[j], &q, &m);
+        }
+    }
+
+    secp256k1_scratch_deallocate_frame(scratch);
+    return ret;
+}
+
 static SECP256K1_INLINE void buffer_append(unsigned char *buf, unsigned int *offset, const void *data, unsigned int len) {
     memcpy(buf + *offset, data, len);
     *offset += len;
@@ -401,6 +521,116 @@ int secp256k1_ecdsa_sign(const secp256k1_context* ctx, secp256k1_ecdsa_signature
     return ret;
 }
 
+int secp256k1_ecdsa_sign_batch(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_ecdsa_signature *sigs, const unsigned char * const *msg32s, size_t n, const unsigned char *seckey, secp256k1_nonce_function noncefp, const void* noncedata) {
+    const size_t item_size = 2 * sizeof(secp256k1_scalar) + sizeof(secp256k1_gej) + sizeof(secp256k1_ge);
+    secp256k1_scalar r, s;
+    secp256k1_scalar sec, msg, blind;
+    secp256k1_scalar *nons;
+    secp256k1_scalar *nonis;
+    secp256k1_gej *rjs;
+    secp256k1_ge *rs;
+    secp256k1_sha256 hash;
+    unsigned char nonce32[32];
+    size_t batch_size;
+    size_t i, j;
+    int overflow = 0;
+    int ret;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    ARG_CHECK(scratch != NULL);
+    ARG_CHECK(n == 0 || sigs != NULL);
+    ARG_CHECK(n == 0 || msg32s != NULL);
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(msg32s[i] != NULL);
+    }
+    ARG_CHECK(seckey != NULL);
+    if (noncefp == NULL) {
+        noncefp = secp256k1_nonce_function_default;
+    }
+
+    secp256k1_scalar_set_b32(&sec, seckey, &overflow);
+    /* Fail if the secret key is invalid. */
+    ret = !overflow && !secp256k1_scalar_is_zero(&sec);
+
+    /* The nonces, their inverses and the nonce points of a batch live in the scratch space. */
+    batch_size = secp256k1_scratch_max_allocation(scratch, 4) / item_size;
+    if (batch_size > n) {
+        batch_size = n;
+    }
+    if (ret && (batch_size == 0 || !secp256k1_scratch_allocate_frame(scratch, batch_size * item_size, 4))) {
+        /* Not enough scratch space to share inversions; sign one message at a time. */
+        for (i = 0; ret && i < n; i++) {
+            ret = secp256k1_ecdsa_sign(ctx, &sigs[i], msg32s[i], seckey, noncefp, noncedata);
+        }
+        batch_size = 0;
+    }
+    if (ret && batch_size > 0) {
+        nons = (secp256k1_scalar*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_scalar));
+        nonis = (secp256k1_scalar*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_scalar));
+        rjs = (secp256k1_gej*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_gej));
+        rs = (secp256k1_ge*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_ge));
+
+        for (i = 0; ret && i < n; i += batch_size) {
+            size_t len = n - i < batch_size ? n - i : batch_size;
+            secp256k1_sha256_initialize(&hash);
+            for (j = 0; ret && j < len; j++) {
+                unsigned int count = 0;
+                while (1) {
+                    ret = noncefp(nonce32, msg32s[i + j], seckey, NULL, (void*)noncedata, count);
+                    if (!ret) {
+                        break;
+                    }
+                    secp256k1_scalar_set_b32(&nons[j], nonce32, &overflow);
+                    if (!overflow && !secp256k1_scalar_is_zero(&nons[j])) {
+                        break;
+                    }
+                    count++;
+                }
+                if (ret) {
+                    secp256k1_sha256_write(&hash, nonce32, 32);
+                    secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &rjs[j], &nons[j]);
+                }
+            }
+            /* The inversion is blinded with a hash of the nonces, which is as secret as they are. */
+            secp256k1_sha256_finalize(&hash, nonce32);
+            if (!ret) {
+                break;
+            }
+            secp256k1_scalar_set_b32(&blind, nonce32, NULL);
+            if (secp256k1_scalar_is_zero(&blind)) {
+                /* This branch true is cryptographically unreachable. */
+                secp256k1_scalar_set_int(&blind, 1);
+            }
+            secp256k1_scalar_inverse_all(nonis, nons, len, &blind);
+            secp256k1_ge_set_all_gej(rs, rjs, len);
+            for (j = 0; ret && j < len; j++) {
+                secp256k1_scalar_set_b32(&msg, msg32s[i + j], NULL);
+                if (secp256k1_ecdsa_sig_sign_inv(&r, &s, &sec, &msg, &rs[j], &nonis[j], NULL)) {
+                    secp256k1_ecdsa_signature_save(&sigs[i + j], &r, &s);
+                } else {
+                    /* This nonce gives s = 0, which is cryptographically unreachable. Let the
+                     * single signing function move on to the next one. */
+                    ret = secp256k1_ecdsa_sign(ctx, &sigs[i + j], msg32s[i + j], seckey, noncefp, noncedata);
+                }
+            }
+        }
+
+        memset(nons, 0, batch_size * sizeof(secp256k1_scalar));
+        memset(nonis, 0, batch_size * sizeof(secp256k1_scalar));
+        memset(rjs, 0, batch_size * sizeof(secp256k1_gej));
+        memset(rs, 0, batch_size * sizeof(secp256k1_ge));
+        secp256k1_scratch_deallocate_frame(scratch);
+    }
+    memset(nonce32, 0, 32);
+    secp256k1_scalar_clear(&msg);
+    secp256k1_scalar_clear(&blind);
+    secp256k1_scalar_clear(&sec);
+    if (!ret && n > 0) {
+        memset(sigs, 0, n * sizeof(*sigs));
+    }
+    return ret;
+}
+
 int secp256k1_ec_seckey_verify(const secp256k1_context* ctx, const unsigned char *seckey) {
     secp256k1_scalar sec;
     int ret;
@@ -437,6 +667,219 @@ int secp256k1_ec_pubkey_create(const secp256k1_context* ctx, secp256k1_pubkey *p
     return ret;
 }
 
+/** Store the public keys ps[0..len-1] at position offset of whichever of pubkeys and
+ *  output33 (compressed serialization) is not NULL. */
+static void secp256k1_pubkey_save_all(secp256k1_pubkey *pubkeys, unsigned char *output33, size_t offset, secp256k1_ge *ps, size_t len) {
+    size_t i;
+    for (i = 0; i < len; i++) {
+        if (output33 != NULL) {
+            size_t size;
+            secp256k1_eckey_pubkey_serialize(&ps[i], &output33[33 * (offset + i)], &size, 1);
+            VERIFY_CHECK(size == 33);
+        }
+        if (pubkeys != NULL) {
+            secp256k1_pubkey_save(&pubkeys[offset + i], &ps[i]);
+        }
+    }
+}
+
+static void secp256k1_pubkey_clear_all(secp256k1_pubkey *pubkeys, unsigned char *output33, size_t n) {
+    if (pubkeys != NULL) {
+        memset(pubkeys, 0, n * sizeof(*pubkeys));
+    }
+    if (output33 != NULL) {
+        memset(output33, 0, n * 33);
+    }
+}
+
+int secp256k1_ec_pubkey_create_batch(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_pubkey *pubkeys, unsigned char *output33, const unsigned char * const *seckeys, size_t n) {
+    secp256k1_gej *pjs;
+    secp256k1_ge *ps;
+    secp256k1_gej pj;
+    secp256k1_ge p;
+    secp256k1_scalar sec;
+    size_t batch_size;
+    size_t i, j;
+    int overflow;
+    int ret = 1;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    ARG_CHECK(scratch != NULL);
+    ARG_CHECK(n == 0 || pubkeys != NULL || output33 != NULL);
+    ARG_CHECK(n == 0 || seckeys != NULL);
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(seckeys[i] != NULL);
+    }
+
+    for (i = 0; i < n; i++) {
+        secp256k1_scalar_set_b32(&sec, seckeys[i], &overflow);
+        ret &= (!overflow) & (!secp256k1_scalar_is_zero(&sec));
+    }
+    if (!ret) {
+        secp256k1_scalar_clear(&sec);
+        secp256k1_pubkey_clear_all(pubkeys, output33, n);
+        return 0;
+    }
+
+    batch_size = secp256k1_scratch_max_allocation(scratch, 2) / (sizeof(secp256k1_gej) + sizeof(secp256k1_ge));
+    if (batch_size > n) {
+        batch_size = n;
+    }
+    if (batch_size == 0 || !secp256k1_scratch_allocate_frame(scratch, batch_size * (sizeof(secp256k1_gej) + sizeof(secp256k1_ge)), 2)) {
+        /* Not enough scratch space to share inversions; use a batch of one on the stack. */
+        batch_size = 1;
+        pjs = &pj;
+        ps = &p;
+    } else {
+        pjs = (secp256k1_gej*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_gej));
+        ps = (secp256k1_ge*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_ge));
+    }
+
+    for (i = 0; i < n; i += batch_size) {
+        size_t len = n - i < batch_size ? n - i : batch_size;
+        for (j = 0; j < len; j++) {
+            secp256k1_scalar_set_b32(&sec, seckeys[i + j], NULL);
+            secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &pjs[j], &sec);
+        }
+        secp256k1_ge_set_all_gej(ps, pjs, len);
+        secp256k1_pubkey_save_all(pubkeys, output33, i, ps, len);
+    }
+
+    secp256k1_scalar_clear(&sec);
+    if (pjs != &pj) {
+        secp256k1_scratch_deallocate_frame(scratch);
+    }
+    return 1;
+}
+
+int secp256k1_ec_pubkey_create_sequence(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_pubkey *pubkeys, unsigned char *output33, const unsigned char *seckey, size_t n) {
+    secp256k1_ge *gs;
+    secp256k1_gej *gjs;
+    secp256k1_ge *ps;
+    secp256k1_fe *ds;
+    secp256k1_ge g1, p2[2];
+    secp256k1_gej gj1, pj;
+    secp256k1_fe d1;
+    secp256k1_scalar sec, last;
+    unsigned char count32[32] = {0};
+    size_t batch_size, k;
+    size_t i, j;
+    int overflow;
+    int affine;
+    int ret;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    ARG_CHECK(scratch != NULL);
+    ARG_CHECK(n == 0 || pubkeys != NULL || output33 != NULL);
+    ARG_CHECK(seckey != NULL);
+
+    secp256k1_scalar_set_b32(&sec, seckey, &overflow);
+    ret = (!overflow) & (!secp256k1_scalar_is_zero(&sec));
+    if (n > 0) {
+        /* Fail if any key of the sequence reaches the group order, i.e. if seckey + n - 1
+         * does not fit. */
+        for (i = 0; i < sizeof(size_t); i++) {
+            count32[31 - i] = ((n - 1) >> (8 * i)) & 0xff;
+        }
+        secp256k1_scalar_set_b32(&last, count32, NULL);
+        ret &= !secp256k1_scalar_add(&last, &sec, &last);
+        secp256k1_scalar_clear(&last);
+    }
+    if (!ret) {
+        secp256k1_scalar_clear(&sec);
+        secp256k1_pubkey_clear_all(pubkeys, output33, n);
+        return 0;
+    }
+    if (n == 0) {
+        secp256k1_scalar_clear(&sec);
+        return 1;
+    }
+
+    /* A batch of k keys takes room for k multiples of G, k + 1 points, k Jacobian points and
+     * k field elements. Computing the multiples costs about as much as k additions and an
+     * inversion, and every batch costs another inversion, so k is kept near 4*sqrt(n) to
+     * balance the two. Below about 128 keys the multiples do not pay off, and every key is
+     * the previous one plus G in Jacobian coordinates instead. */
+    batch_size = secp256k1_scratch_max_allocation(scratch, 4);
+    batch_size = batch_size < sizeof(secp256k1_ge) ? 0 : (batch_size - sizeof(secp256k1_ge)) / (2 * sizeof(secp256k1_ge) + sizeof(secp256k1_gej) + sizeof(secp256k1_fe));
+    affine = n >= 128;
+    if (affine) {
+        k = 4;
+        while (k / 4 < n / (k / 4)) {
+            k *= 2;
+        }
+        if (batch_size > k) {
+            batch_size = k;
+        }
+    }
+    if (batch_size > n) {
+        batch_size = n;
+    }
+    if (batch_size == 0 || !secp256k1_scratch_allocate_frame(scratch, batch_size * (2 * sizeof(secp256k1_ge) + sizeof(secp256k1_gej) + sizeof(secp256k1_fe)) + sizeof(secp256k1_ge), 4)) {
+        batch_size = 1;
+        gs = &g1;
+        gjs = &gj1;
+        ps = p2;
+        ds = &d1;
+    } else {
+        gs = (secp256k1_ge*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_ge));
+        gjs = (secp256k1_gej*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_gej));
+        ps = (secp256k1_ge*)secp256k1_scratch_alloc(scratch, (batch_size + 1) * sizeof(secp256k1_ge));
+        ds = (secp256k1_fe*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_fe));
+    }
+
+    if (affine) {
+        /* The multiples of G are public. */
+        secp256k1_gej_set_ge(&gjs[0], &secp256k1_ge_const_g);
+        for (j = 1; j < batch_size; j++) {
+            secp256k1_gej_add_ge_var(&gjs[j], &gjs[j - 1], &secp256k1_ge_const_g, &ds[j]);
+        }
+        secp256k1_ge_set_table_gej_var(gs, gjs, ds, batch_size);
+    }
+
+    /* Only the first key needs a multiplication. */
+    secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &pj, &sec);
+    if (affine) {
+        secp256k1_ge_set_gej(&ps[0], &pj);
+    }
+    for (i = 0; i < n; i += batch_size) {
+        size_t len = n - i < batch_size ? n - i : batch_size;
+        if (affine) {
+            /* Every batch starts at a point B, and the points B + jG that follow it, including
+             * the start of the next batch, are independent additions that share one inversion. */
+            size_t adds = i + len < n ? len : len - 1;
+            if (!secp256k1_ge_add_all_ge(&ps[1], ds, &ps[0], gs, adds)) {
+                /* B = +-jG for some j <= batch_size, which only happens for tiny keys or keys
+                 * right below the group order. The Jacobian addition also handles doubling. */
+                secp256k1_gej_set_ge(&pj, &ps[0]);
+                for (j = 0; j < adds; j++) {
+                    secp256k1_gej_add_ge(&pj, &pj, &secp256k1_ge_const_g);
+                    gjs[j] = pj;
+                }
+                secp256k1_ge_set_all_gej(&ps[1], gjs, adds);
+            }
+            secp256k1_pubkey_save_all(pubkeys, output33, i, ps, len);
+            ps[0] = ps[adds];
+        } else {
+            for (j = 0; j < len; j++) {
+                if (i + j > 0) {
+                    secp256k1_gej_add_ge(&pj, &pj, &secp256k1_ge_const_g);
+                }
+                gjs[j] = pj;
+            }
+            secp256k1_ge_set_all_gej(ps, gjs, len);
+            secp256k1_pubkey_save_all(pubkeys, output33, i, ps, len);
+        }
+    }
+
+    secp256k1_scalar_clear(&sec);
+    secp256k1_gej_clear(&pj);
+    if (gs != &g1) {
+        secp256k1_scratch_deallocate_frame(scratch);
+    }
+    return 1;
+}
+
 int secp256k1_ec_privkey_negate(const secp256k1_context* ctx, unsigned char *seckey) {
     secp256k1_scalar sec;
     VERIFY_CHECK(ctx != NULL);
@@ -501,7 +944,7 @@ int secp256k1_ec_pubkey_tweak_add(const secp256k1_context* ctx, secp256k1_pubkey
     ret = !overflow && secp256k1_pubkey_load(ctx, &p, pubkey);
     memset(pubkey, 0, sizeof(*pubkey));
     if (ret) {
-        if (secp256k1_eckey_pubkey_tweak_add(&ctx->ecmult_ctx, &p, &term)) {
+        if (secp256k1_eckey_pubkey_tweak_add(&ctx->ecmult_ctx, &ctx->ecmult_gen_ctx, &p, &term)) {
             secp256k1_pubkey_save(pubkey, &p);
         } else {
             ret = 0;
@@ -511,6 +954,75 @@ int secp256k1_ec_pubkey_tweak_add(const secp256k1_context* ctx, secp256k1_pubkey
     return ret;
 }
 
+int secp256k1_ec_pubkey_tweak_add_batch(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_pubkey *pubkeys, const unsigned char * const *tweaks, size_t n) {
+    const size_t item_size = sizeof(secp256k1_gej) + sizeof(secp256k1_ge) + 2 * sizeof(secp256k1_fe) + sizeof(int);
+    secp256k1_gej *pjs;
+    secp256k1_ge *ps;
+    secp256k1_fe *zs;
+    secp256k1_fe *zis;
+    int *oks;
+    size_t batch_size;
+    size_t i, j;
+    int ret = 1;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(scratch != NULL);
+    ARG_CHECK(n == 0 || pubkeys != NULL);
+    ARG_CHECK(n == 0 || tweaks != NULL);
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(tweaks[i] != NULL);
+    }
+
+    batch_size = secp256k1_scratch_max_allocation(scratch, 5) / item_size;
+    if (batch_size > n) {
+        batch_size = n;
+    }
+    if (batch_size == 0 || !secp256k1_scratch_allocate_frame(scratch, batch_size * item_size, 5)) {
+        /* Not enough scratch space to share inversions; tweak one key at a time. */
+        for (i = 0; i < n; i++) {
+            ret &= secp256k1_ec_pubkey_tweak_add(ctx, &pubkeys[i], tweaks[i]);
+        }
+        return ret;
+    }
+    pjs = (secp256k1_gej*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_gej));
+    ps = (secp256k1_ge*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_ge));
+    zs = (secp256k1_fe*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_fe));
+    zis = (secp256k1_fe*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(secp256k1_fe));
+    oks = (int*)secp256k1_scratch_alloc(scratch, batch_size * sizeof(int));
+
+    for (i = 0; i < n; i += batch_size) {
+        size_t len = n - i < batch_size ? n - i : batch_size;
+        /* Keys that cannot be tweaked take part in the inversion with a dummy value of 1. */
+        for (j = 0; j < len; j++) {
+            secp256k1_scalar term;
+            int overflow = 0;
+            secp256k1_scalar_set_b32(&term, tweaks[i + j], &overflow);
+            oks[j] = !overflow && secp256k1_pubkey_load(ctx, &ps[j], &pubkeys[i + j]);
+            secp256k1_fe_set_int(&zs[j], 1);
+            if (oks[j]) {
+                secp256k1_eckey_pubkey_tweak_add_var(&ctx->ecmult_ctx, &ctx->ecmult_gen_ctx, &pjs[j], &ps[j], &term);
+                oks[j] = !secp256k1_gej_is_infinity(&pjs[j]);
+                if (oks[j]) {
+                    zs[j] = pjs[j].z;
+                }
+            }
+        }
+        secp256k1_fe_inv_all_var(zis, zs, len);
+        for (j = 0; j < len; j++) {
+            if (oks[j]) {
+                secp256k1_ge_set_gej_zinv(&ps[j], &pjs[j], &zis[j]);
+                secp256k1_pubkey_save(&pubkeys[i + j], &ps[j]);
+            } else {
+                memset(&pubkeys[i + j], 0, sizeof(pubkeys[i + j]));
+                ret = 0;
+            }
+        }
+    }
+
+    secp256k1_scratch_deallocate_frame(scratch);
+    return ret;
+}
+
 int secp256k1_ec_privkey_tweak_mul(const secp256k1_context* ctx, unsigned char *seckey, const unsigned char *tweak) {
     secp256k1_scalar factor;
     secp256k1_scalar sec;
@@ -547,7 +1059,7 @@ int secp256k1_ec_pubkey_tweak_mul(const secp256k1_context* ctx, secp256k1_pubkey
     ret = !overflow && secp256k1_pubkey_load(ctx, &p, pubkey);
     memset(pubkey, 0, sizeof(*pubkey));
     if (ret) {
-        if (secp256k1_eckey_pubkey_tweak_mul(&ctx->ecmult_ctx, &p, &factor)) {
+        if (secp256k1_eckey_pubkey_tweak_mul(&p, &factor)) {
             secp256k1_pubkey_save(pubkey, &p);
         } else {
             ret = 0;
@@ -595,3 +1107,7 @@ int secp256k1_ec_pubkey_combine(const secp256k1_context* ctx, secp256k1_pubkey *
 #ifdef ENABLE_MODULE_RECOVERY
 # include "modules/recovery/main_impl.h"
 #endif
+
+#ifdef ENABLE_MODULE_TABLEFILE
+# include "modules/tablefile/main_impl.h"
+#endif
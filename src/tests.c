@@ -227,7 +227,7 @@ void run_context_tests(void) {
 
     /* This shouldn't leak memory, due to already-set tests. */
     secp256k1_ecmult_gen_context_build(&sign->ecmult_gen_ctx, NULL);
-    secp256k1_ecmult_context_build(&vrfy->ecmult_ctx, NULL);
+    secp256k1_ecmult_context_build(&vrfy->ecmult_ctx, WINDOW_G, NULL);
 
     /* obtain a working nonce */
     do {
@@ -251,6 +251,113 @@ void run_context_tests(void) {
     secp256k1_context_destroy(NULL);
 }
 
+void test_context_window(int window) {
+    secp256k1_context *vrfy = secp256k1_context_create_with_window(SECP256K1_CONTEXT_VERIFY, window);
+    secp256k1_context *ctx_tmp;
+    secp256k1_ecdsa_signature sig;
+    secp256k1_pubkey pubkey;
+    unsigned char msg[32];
+    unsigned char seckey[32];
+    secp256k1_scalar key, na, ng;
+    secp256k1_ge ge;
+    secp256k1_gej a, r1, r2;
+
+    CHECK(vrfy != NULL);
+    CHECK(vrfy->ecmult_ctx.window_g == window);
+    ctx_tmp = vrfy; vrfy = secp256k1_context_clone(vrfy); secp256k1_context_destroy(ctx_tmp);
+    CHECK(vrfy->ecmult_ctx.window_g == window);
+
+    random_group_element_test(&ge);
+    random_group_element_jacobian_test(&a, &ge);
+    random_scalar_order_test(&na);
+    random_scalar_order_test(&ng);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &r1, &a, &na, &ng);
+    secp256k1_ecmult(&vrfy->ecmult_ctx, &r2, &a, &na, &ng);
+    secp256k1_gej_neg(&r2, &r2);
+    secp256k1_gej_add_var(&r2, &r2, &r1, NULL);
+    CHECK(secp256k1_gej_is_infinity(&r2));
+
+    random_scalar_order_test(&key);
+    secp256k1_scalar_get_b32(seckey, &key);
+    secp256k1_rand256_test(msg);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, seckey) == 1);
+    CHECK(secp256k1_ecdsa_sign(ctx, &sig, msg, seckey, NULL, NULL) == 1);
+    CHECK(secp256k1_ecdsa_verify(vrfy, &sig, msg, &pubkey) == 1);
+    msg[0] ^= 1;
+    CHECK(secp256k1_ecdsa_verify(vrfy, &sig, msg, &pubkey) == 0);
+
+    secp256k1_context_destroy(vrfy);
+}
+
+void test_ecmult_context_tables(void) {
+    secp256k1_ge_storage *table = (secp256k1_ge_storage*)checked_malloc(&ctx->error_callback, sizeof(*table) * ECMULT_TABLE_SIZE(WINDOW_G));
+    secp256k1_gej gj;
+    int i;
+
+    /* The tables of the default context, static or not, are the odd multiples of G (and 2^128*G). */
+    CHECK(ctx->ecmult_ctx.window_g == WINDOW_G);
+    secp256k1_gej_set_ge(&gj, &secp256k1_ge_const_g);
+    secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(WINDOW_G), table, &gj, &ctx->error_callback);
+    CHECK(memcmp(table, *ctx->ecmult_ctx.pre_g, sizeof(*table) * ECMULT_TABLE_SIZE(WINDOW_G)) == 0);
+#ifdef USE_ENDOMORPHISM
+    for (i = 0; i < 128; i++) {
+        secp256k1_gej_double_var(&gj, &gj, NULL);
+    }
+    secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(WINDOW_G), table, &gj, &ctx->error_callback);
+    CHECK(memcmp(table, *ctx->ecmult_ctx.pre_g_128, sizeof(*table) * ECMULT_TABLE_SIZE(WINDOW_G)) == 0);
+#else
+    (void)i;
+#endif
+    free(table);
+}
+
+void test_context_clone_shares_tables(void) {
+    secp256k1_context *both = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
+    secp256k1_context *copy = secp256k1_context_clone(both);
+    secp256k1_context *copy2 = secp256k1_context_clone(copy);
+    unsigned char seed[32];
+    unsigned char seckey[32];
+    unsigned char msg[32];
+    secp256k1_ecdsa_signature sig;
+    secp256k1_pubkey pubkey;
+    secp256k1_scalar key, b, b2;
+    secp256k1_gej initial, initial2;
+
+#ifdef HAVE_BUILTIN_ATOMICS
+    CHECK(copy->ecmult_ctx.pre_g == both->ecmult_ctx.pre_g);
+    CHECK(copy2->ecmult_gen_ctx.prec == both->ecmult_gen_ctx.prec);
+#endif
+    /* The blinding is per context. */
+    secp256k1_rand256(seed);
+    CHECK(secp256k1_context_randomize(copy, seed) == 1);
+    secp256k1_ecmult_gen_load_blinding(&both->ecmult_gen_ctx, &b, &initial);
+    secp256k1_ecmult_gen_load_blinding(&copy->ecmult_gen_ctx, &b2, &initial2);
+    CHECK(!secp256k1_scalar_eq(&b2, &b));
+    secp256k1_ecmult_gen_load_blinding(&copy2->ecmult_gen_ctx, &b2, &initial2);
+    CHECK(secp256k1_scalar_eq(&b2, &b));
+
+    /* The tables outlive the context they were built for. */
+    secp256k1_context_destroy(both);
+    random_scalar_order_test(&key);
+    secp256k1_scalar_get_b32(seckey, &key);
+    secp256k1_rand256_test(msg);
+    CHECK(secp256k1_ec_pubkey_create(copy, &pubkey, seckey) == 1);
+    CHECK(secp256k1_ecdsa_sign(copy, &sig, msg, seckey, NULL, NULL) == 1);
+    CHECK(secp256k1_ecdsa_verify(copy, &sig, msg, &pubkey) == 1);
+    secp256k1_context_destroy(copy);
+    CHECK(secp256k1_ecdsa_sign(copy2, &sig, msg, seckey, NULL, NULL) == 1);
+    CHECK(secp256k1_ecdsa_verify(copy2, &sig, msg, &pubkey) == 1);
+    secp256k1_context_destroy(copy2);
+}
+
+void run_context_window_tests(void) {
+    test_ecmult_context_tables();
+    test_context_clone_shares_tables();
+    test_context_window(WINDOW_G_MIN);
+    test_context_window(WINDOW_G_MIN + 1);
+    test_context_window(WINDOW_G_MIN + 2 + secp256k1_rand_int(11 - WINDOW_G_MIN));
+}
+
 void run_scratch_tests(void) {
     int32_t ecount = 0;
     secp256k1_context *none = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
@@ -961,12 +1068,87 @@ void scalar_test(void) {
 
 }
 
+/* Check secp256k1_scalar_inverse and secp256k1_scalar_inverse_var against each other on x,
+ * and that they invert it. */
+void test_scalar_inv_both(const secp256k1_scalar *x) {
+    secp256k1_scalar xi, xi_var, t;
+    secp256k1_scalar_inverse(&xi, x);
+    CHECK(!secp256k1_scalar_check_overflow(&xi));
+    if (secp256k1_scalar_is_zero(x)) {
+        CHECK(secp256k1_scalar_is_zero(&xi));
+#ifdef USE_SCALAR_INV_NUM
+        /* The num-based inverse does not accept zero. */
+        return;
+#endif
+    } else {
+        secp256k1_scalar_mul(&t, x, &xi);
+        CHECK(secp256k1_scalar_is_one(&t));
+    }
+    secp256k1_scalar_inverse_var(&xi_var, x);
+    CHECK(secp256k1_scalar_eq(&xi, &xi_var));
+}
+
+void run_scalar_inv_special(void) {
+    secp256k1_scalar x;
+    unsigned char b32[32];
+    int i;
+
+    secp256k1_scalar_set_int(&x, 0);
+    test_scalar_inv_both(&x);
+    secp256k1_scalar_set_int(&x, 1);
+    test_scalar_inv_both(&x);
+    secp256k1_scalar_negate(&x, &x);
+    test_scalar_inv_both(&x);
+    /* Powers of two, and n minus them. */
+    for (i = 0; i < 256; i++) {
+        int overflow;
+        memset(b32, 0, 32);
+        b32[31 - i / 8] = 1 << (i % 8);
+        secp256k1_scalar_set_b32(&x, b32, &overflow);
+        if (!overflow) {
+            test_scalar_inv_both(&x);
+            secp256k1_scalar_negate(&x, &x);
+            test_scalar_inv_both(&x);
+        }
+    }
+    /* Values with long runs of ones and zeros. */
+    for (i = 0; i < 10*count; i++) {
+        random_scalar_order_test(&x);
+        test_scalar_inv_both(&x);
+    }
+}
+
 void run_scalar_tests(void) {
     int i;
     for (i = 0; i < 128 * count; i++) {
         scalar_test();
     }
 
+    {
+        /* Batch inversion agrees with individual inversions. */
+        secp256k1_scalar x[16], xi[16], xii[16];
+        size_t j;
+        /* Check it's safe to call for 0 elements */
+        secp256k1_scalar_inverse_all_var(xi, x, 0);
+        for (i = 0; i < count; i++) {
+            size_t len = secp256k1_rand_int(15) + 1;
+            for (j = 0; j < len; j++) {
+                do {
+                    random_scalar_order_test(&x[j]);
+                } while (secp256k1_scalar_is_zero(&x[j]));
+            }
+            secp256k1_scalar_inverse_all_var(xi, x, len);
+            for (j = 0; j < len; j++) {
+                secp256k1_scalar_inverse_var(&xii[j], &x[j]);
+                CHECK(secp256k1_scalar_eq(&xi[j], &xii[j]));
+            }
+            secp256k1_scalar_inverse_all_var(xii, xi, len);
+            for (j = 0; j < len; j++) {
+                CHECK(secp256k1_scalar_eq(&x[j], &xii[j]));
+            }
+        }
+    }
+
     {
         /* (-1)+1 should be zero. */
         secp256k1_scalar s, o;
@@ -1016,7 +1198,7 @@ void run_scalar_tests(void) {
         secp256k1_scalar one;
         secp256k1_scalar r1;
         secp256k1_scalar r2;
-#if defined(USE_SCALAR_INV_NUM)
+#if !defined(USE_SCALAR_INV_BUILTIN)
         secp256k1_scalar zzv;
 #endif
         int overflow;
@@ -1568,7 +1750,7 @@ void run_scalar_tests(void) {
             if (!secp256k1_scalar_is_zero(&y)) {
                 secp256k1_scalar_inverse(&zz, &y);
                 CHECK(!secp256k1_scalar_check_overflow(&zz));
-#if defined(USE_SCALAR_INV_NUM)
+#if !defined(USE_SCALAR_INV_BUILTIN)
                 secp256k1_scalar_inverse_var(&zzv, &y);
                 CHECK(secp256k1_scalar_eq(&zzv, &zz));
 #endif
@@ -1782,6 +1964,58 @@ void run_field_inv_var(void) {
     }
 }
 
+/* Check secp256k1_fe_inv and secp256k1_fe_inv_var against each other on x, and that they invert it. */
+void test_fe_inv_both(const secp256k1_fe *x) {
+    secp256k1_fe xi, xi_var, xn = *x;
+    secp256k1_fe_inv(&xi, x);
+    if (secp256k1_fe_normalizes_to_zero_var(&xn)) {
+        CHECK(secp256k1_fe_normalizes_to_zero_var(&xi));
+#ifdef USE_FIELD_INV_NUM
+        /* The num-based inverse does not accept zero. */
+        return;
+#endif
+    } else {
+        CHECK(check_fe_inverse(x, &xi));
+    }
+    secp256k1_fe_inv_var(&xi_var, x);
+    CHECK(check_fe_equal(&xi, &xi_var));
+}
+
+void run_field_inv_special(void) {
+    static const secp256k1_fe zero = SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 0);
+    static const secp256k1_fe pm1 = SECP256K1_FE_CONST(
+        0xFFFFFFFFUL, 0xFFFFFFFFUL, 0xFFFFFFFFUL, 0xFFFFFFFFUL,
+        0xFFFFFFFFUL, 0xFFFFFFFFUL, 0xFFFFFFFEUL, 0xFFFFFC2EUL
+    );
+    secp256k1_fe x, p;
+    unsigned char b32[32];
+    int i;
+
+    test_fe_inv_both(&zero);
+    test_fe_inv_both(&pm1);
+    /* p itself, which is zero but not normalized. */
+    secp256k1_fe_clear(&p);
+    secp256k1_fe_negate(&p, &p, 0);
+    test_fe_inv_both(&p);
+    /* Powers of two, and p minus them. */
+    for (i = 0; i < 256; i++) {
+        memset(b32, 0, 32);
+        b32[31 - i / 8] = 1 << (i % 8);
+        if (secp256k1_fe_set_b32(&x, b32)) {
+            test_fe_inv_both(&x);
+            secp256k1_fe_negate(&x, &x, 1);
+            test_fe_inv_both(&x);
+        }
+    }
+    /* Values with long runs of ones and zeros, and of large magnitude. */
+    for (i = 0; i < 10*count; i++) {
+        random_field_element_test(&x);
+        test_fe_inv_both(&x);
+        random_field_element_magnitude(&x);
+        test_fe_inv_both(&x);
+    }
+}
+
 void run_field_inv_all_var(void) {
     secp256k1_fe x[16], xi[16], xii[16];
     int i;
@@ -1824,6 +2058,7 @@ void test_sqrt(const secp256k1_fe *a, const secp256k1_fe *k) {
     secp256k1_fe r1, r2;
     int v = secp256k1_fe_sqrt(&r1, a);
     CHECK((v == 0) == (k == NULL));
+    CHECK(secp256k1_fe_is_quad_var(a) == v);
 
     if (k != NULL) {
         /* Check that the returned root is +/- the given known answer */
@@ -1834,6 +2069,77 @@ void test_sqrt(const secp256k1_fe *a, const secp256k1_fe *k) {
     }
 }
 
+void run_fe_is_quad(void) {
+    secp256k1_fe x, r;
+    unsigned char b32[32];
+    int i;
+
+    /* Powers of two and their negations, and values with long runs of ones and zeros, against
+     * the existence of a square root. */
+    for (i = 0; i < 256; i++) {
+        memset(b32, 0, 32);
+        b32[31 - i / 8] = 1 << (i % 8);
+        if (secp256k1_fe_set_b32(&x, b32)) {
+            CHECK(secp256k1_fe_is_quad_var(&x) == secp256k1_fe_sqrt(&r, &x));
+            secp256k1_fe_negate(&x, &x, 1);
+            CHECK(secp256k1_fe_is_quad_var(&x) == secp256k1_fe_sqrt(&r, &x));
+        }
+    }
+    for (i = 0; i < 10*count; i++) {
+        random_field_element_test(&x);
+        CHECK(secp256k1_fe_is_quad_var(&x) == secp256k1_fe_sqrt(&r, &x));
+        random_field_element_magnitude(&x);
+        CHECK(secp256k1_fe_is_quad_var(&x) == secp256k1_fe_sqrt(&r, &x));
+    }
+}
+
+void run_kernels(void) {
+    CHECK(strcmp(secp256k1_context_get_kernel(ctx), secp256k1_kernel_name(secp256k1_kernel_get())) == 0);
+#ifdef USE_RUNTIME_DISPATCH
+    {
+        const int selected = secp256k1_kernel_get();
+        secp256k1_fe a, b, x[2], y[2];
+        secp256k1_scalar sa, sb, sx[2], sy[2];
+        int i, k;
+        CHECK(secp256k1_kernel_supported(SECP256K1_KERNEL_GENERIC));
+        CHECK(secp256k1_kernel_supported(SECP256K1_KERNEL_X86_64));
+        for (i = 0; i < count * 8; i++) {
+            random_fe_test(&a);
+            random_fe_test(&b);
+            if (secp256k1_rand_bits(1)) {
+                /* Magnitude 8, the largest multiplication accepts. */
+                secp256k1_fe_negate(&a, &a, 1);
+                secp256k1_fe_mul_int(&a, 4);
+            }
+            random_scalar_order_test(&sa);
+            random_scalar_order_test(&sb);
+            secp256k1_kernel_set(SECP256K1_KERNEL_GENERIC);
+            secp256k1_fe_mul(&x[0], &a, &b);
+            secp256k1_fe_sqr(&x[1], &a);
+            secp256k1_scalar_mul(&sx[0], &sa, &sb);
+            secp256k1_scalar_sqr(&sx[1], &sa);
+            for (k = SECP256K1_KERNEL_X86_64; k <= SECP256K1_KERNEL_BMI2; k++) {
+                if (!secp256k1_kernel_supported(k)) {
+                    continue;
+                }
+                secp256k1_kernel_set(k);
+                y[0] = a;
+                secp256k1_fe_mul(&y[0], &y[0], &b);
+                y[1] = a;
+                secp256k1_fe_sqr(&y[1], &y[1]);
+                secp256k1_scalar_mul(&sy[0], &sa, &sb);
+                secp256k1_scalar_sqr(&sy[1], &sa);
+                CHECK(secp256k1_fe_equal_var(&x[0], &y[0]));
+                CHECK(secp256k1_fe_equal_var(&x[1], &y[1]));
+                CHECK(secp256k1_scalar_eq(&sx[0], &sy[0]));
+                CHECK(secp256k1_scalar_eq(&sx[1], &sy[1]));
+            }
+        }
+        secp256k1_kernel_set(selected);
+    }
+#endif
+}
+
 void run_sqrt(void) {
     secp256k1_fe ns, x, s, t;
     int i;
@@ -2425,6 +2731,56 @@ void run_point_times_order(void) {
     CHECK(secp256k1_fe_equal_var(&x, &xr));
 }
 
+void test_ecmult_with_table(void) {
+    secp256k1_ecmult_point_table tbl;
+    secp256k1_ge a;
+    secp256k1_gej aj, r1, r2;
+    secp256k1_scalar na, ng;
+
+    random_group_element_test(&a);
+    secp256k1_gej_set_ge(&aj, &a);
+    secp256k1_ecmult_point_table_init(&tbl);
+    secp256k1_ecmult_point_table_build(&tbl, &a, &ctx->error_callback);
+
+    random_scalar_order_test(&na);
+    random_scalar_order_test(&ng);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &r1, &aj, &na, &ng);
+    secp256k1_ecmult_with_table(&ctx->ecmult_ctx, &tbl, &r2, &na, &ng);
+    secp256k1_gej_neg(&r2, &r2);
+    secp256k1_gej_add_var(&r2, &r2, &r1, NULL);
+    CHECK(secp256k1_gej_is_infinity(&r2));
+
+    /* Only one of the two terms. */
+    secp256k1_ecmult(&ctx->ecmult_ctx, &r1, &aj, &na, NULL);
+    secp256k1_ecmult_with_table(&ctx->ecmult_ctx, &tbl, &r2, &na, NULL);
+    secp256k1_gej_neg(&r2, &r2);
+    secp256k1_gej_add_var(&r2, &r2, &r1, NULL);
+    CHECK(secp256k1_gej_is_infinity(&r2));
+    secp256k1_scalar_set_int(&na, 0);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &r1, &aj, &na, &ng);
+    secp256k1_ecmult_with_table(&ctx->ecmult_ctx, &tbl, &r2, &na, &ng);
+    secp256k1_gej_neg(&r2, &r2);
+    secp256k1_gej_add_var(&r2, &r2, &r1, NULL);
+    CHECK(secp256k1_gej_is_infinity(&r2));
+
+    /* The two terms cancel out. */
+    secp256k1_scalar_set_int(&na, 1);
+    secp256k1_ecmult_point_table_clear(&tbl);
+    secp256k1_ecmult_point_table_build(&tbl, &secp256k1_ge_const_g, &ctx->error_callback);
+    secp256k1_scalar_negate(&ng, &na);
+    secp256k1_ecmult_with_table(&ctx->ecmult_ctx, &tbl, &r2, &na, &ng);
+    CHECK(secp256k1_gej_is_infinity(&r2));
+
+    secp256k1_ecmult_point_table_clear(&tbl);
+}
+
+void run_ecmult_with_table(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_ecmult_with_table();
+    }
+}
+
 void ecmult_const_random_mult(void) {
     /* random starting point A (on the curve) */
     secp256k1_ge a = SECP256K1_GE_CONST(
@@ -2521,7 +2877,31 @@ void ecmult_const_chain_multiply(void) {
     ge_equals_gej(&res, &expected_point);
 }
 
+void ecmult_const_tweak_mul_compare(void) {
+    /* secp256k1_ec_pubkey_tweak_mul and secp256k1_ecmult_const compute the same product. */
+    secp256k1_scalar x;
+    secp256k1_gej resj;
+    secp256k1_ge a, res;
+    secp256k1_pubkey pubkey;
+    unsigned char x32[32];
+
+    random_scalar_order_test(&x);
+    random_group_element_test(&a);
+    secp256k1_ecmult_const(&resj, &a, &x, 256);
+    secp256k1_ge_set_gej(&res, &resj);
+
+    secp256k1_pubkey_save(&pubkey, &a);
+    secp256k1_scalar_get_b32(x32, &x);
+    CHECK(secp256k1_ec_pubkey_tweak_mul(ctx, &pubkey, x32) == 1);
+    CHECK(secp256k1_pubkey_load(ctx, &a, &pubkey));
+    ge_equals_ge(&a, &res);
+}
+
 void run_ecmult_const_tests(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        ecmult_const_tweak_mul_compare();
+    }
     ecmult_const_mult_zero_one();
     ecmult_const_random_mult();
     ecmult_const_commutativity();
@@ -2531,6 +2911,7 @@ void run_ecmult_const_tests(void) {
 typedef struct {
     secp256k1_scalar *sc;
     secp256k1_ge *pt;
+    size_t fail_idx;
 } ecmult_multi_data;
 
 static int ecmult_multi_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *cbdata) {
@@ -2812,7 +3193,8 @@ void test_secp256k1_pippenger_bucket_window_inv(void) {
  */
 void test_ecmult_multi_pippenger_max_points(void) {
     size_t scratch_size = secp256k1_rand_int(256);
-    size_t max_size = secp256k1_pippenger_scratch_size(secp256k1_pippenger_bucket_window_inv(PIPPENGER_MAX_BUCKET_WINDOW-1)+512, 12);
+    /* Large enough that the (smaller) per-point size of the largest bucket window makes up for its larger bucket space. */
+    size_t max_size = secp256k1_pippenger_scratch_size(secp256k1_pippenger_bucket_window_inv(PIPPENGER_MAX_BUCKET_WINDOW-1)+2048, 12);
     secp256k1_scratch *scratch;
     size_t n_points_supported;
     int bucket_window = 0;
@@ -2898,6 +3280,181 @@ void test_ecmult_multi_batching(void) {
     free(pt);
 }
 
+static void executor_run_forward(secp256k1_executor_job *job, void *job_data, size_t n_jobs, void *data) {
+    size_t i;
+    (void)data;
+    for (i = 0; i < n_jobs; i++) {
+        job(job_data, i);
+    }
+}
+
+static void executor_run_reverse(secp256k1_executor_job *job, void *job_data, size_t n_jobs, void *data) {
+    size_t i;
+    (void)data;
+    for (i = n_jobs; i > 0; i--) {
+        job(job_data, i - 1);
+    }
+}
+
+static int ecmult_multi_false_callback_at(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *cbdata) {
+    ecmult_multi_data *data = (ecmult_multi_data*) cbdata;
+    if (idx == data->fail_idx) {
+        return 0;
+    }
+    *sc = data->sc[idx];
+    *pt = data->pt[idx];
+    return 1;
+}
+
+void test_ecmult_multi_parallel(void) {
+    static const size_t n_points = 3*ECMULT_PIPPENGER_THRESHOLD;
+    secp256k1_scalar scG;
+    secp256k1_scalar *sc = (secp256k1_scalar *)checked_malloc(&ctx->error_callback, sizeof(secp256k1_scalar) * n_points);
+    secp256k1_ge *pt = (secp256k1_ge *)checked_malloc(&ctx->error_callback, sizeof(secp256k1_ge) * n_points);
+    secp256k1_scratch *scratch[4];
+    secp256k1_scratch *big_scratch = secp256k1_scratch_create(&ctx->error_callback, 819200);
+    secp256k1_executor forward, reverse;
+    ecmult_multi_data data;
+    size_t i;
+    int k;
+
+    forward.run = executor_run_forward;
+    forward.data = NULL;
+    reverse.run = executor_run_reverse;
+    reverse.data = NULL;
+
+    random_scalar_order(&scG);
+    for (i = 0; i < n_points; i++) {
+        random_group_element_test(&pt[i]);
+        random_scalar_order(&sc[i]);
+    }
+    data.sc = sc;
+    data.pt = pt;
+
+    for (k = 0; k < 2*count; k++) {
+        size_t n_scratch = secp256k1_rand_int(4) + 1;
+        size_t n = secp256k1_rand_int(n_points + 1);
+        const secp256k1_executor *executor = secp256k1_rand_bits(1) ? &forward : &reverse;
+        secp256k1_gej r, r2;
+
+        for (i = 0; i < n_scratch; i++) {
+            /* Between room for a single Strauss point and room for everything. */
+            size_t size = secp256k1_strauss_scratch_size(1) + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT + 2*ALIGNMENT + 4*sizeof(struct secp256k1_ecmult_multi_worker);
+            if (secp256k1_rand_bits(1)) {
+                /* Enough to split the windows of all points over the workers */
+                size = secp256k1_pippenger_scratch_size(n_points, secp256k1_pippenger_bucket_window(n_points)) + secp256k1_pippenger_jobs_scratch_size(n_points, secp256k1_pippenger_bucket_window(n_points), 4) + (PIPPENGER_SCRATCH_OBJECTS + 1)*ALIGNMENT;
+            } else if (secp256k1_rand_bits(1)) {
+                size += secp256k1_rand_int(secp256k1_strauss_scratch_size(64));
+            }
+            scratch[i] = secp256k1_scratch_create(&ctx->error_callback, size);
+        }
+
+        CHECK(secp256k1_ecmult_multi_var(&ctx->ecmult_ctx, big_scratch, &r2, &scG, ecmult_multi_callback, &data, n));
+        CHECK(secp256k1_ecmult_multi_var_parallel(&ctx->ecmult_ctx, executor, scratch, n_scratch, &r, &scG, ecmult_multi_callback, &data, n));
+        secp256k1_gej_neg(&r2, &r2);
+        secp256k1_gej_add_var(&r, &r, &r2, NULL);
+        CHECK(secp256k1_gej_is_infinity(&r));
+
+        CHECK(secp256k1_ecmult_multi_var(&ctx->ecmult_ctx, big_scratch, &r2, NULL, ecmult_multi_callback, &data, n));
+        CHECK(secp256k1_ecmult_multi_var_parallel(&ctx->ecmult_ctx, executor, scratch, n_scratch, &r, NULL, ecmult_multi_callback, &data, n));
+        secp256k1_gej_neg(&r2, &r2);
+        secp256k1_gej_add_var(&r, &r, &r2, NULL);
+        CHECK(secp256k1_gej_is_infinity(&r));
+
+        /* A failing callback in any worker makes the whole computation fail. */
+        if (n > 0) {
+            data.fail_idx = secp256k1_rand_int(n);
+            CHECK(!secp256k1_ecmult_multi_var_parallel(&ctx->ecmult_ctx, executor, scratch, n_scratch, &r, &scG, ecmult_multi_false_callback_at, &data, n));
+        }
+
+        for (i = 0; i < n_scratch; i++) {
+            CHECK(scratch[i]->frame == 0);
+            secp256k1_scratch_destroy(scratch[i]);
+        }
+    }
+
+    /* Split the windows of a single Pippenger batch over a varying number of jobs. */
+    for (k = 0; k < count; k++) {
+        size_t n = secp256k1_rand_int(n_points) + 1;
+        size_t n_jobs = secp256k1_rand_int(WNAF_SIZE(2) + 2) + 1;
+        int bucket_window = secp256k1_pippenger_bucket_window(n);
+        size_t size = secp256k1_pippenger_scratch_size(n, bucket_window) + secp256k1_pippenger_jobs_scratch_size(n, bucket_window, n_jobs) + (PIPPENGER_SCRATCH_OBJECTS + 1)*ALIGNMENT;
+        secp256k1_gej r, r2;
+
+        scratch[0] = secp256k1_scratch_create(&ctx->error_callback, size);
+        CHECK(secp256k1_ecmult_multi_var(&ctx->ecmult_ctx, big_scratch, &r2, &scG, ecmult_multi_callback, &data, n));
+        CHECK(secp256k1_ecmult_pippenger_batch_jobs(&ctx->ecmult_ctx, secp256k1_rand_bits(1) ? &forward : &reverse, n_jobs, scratch[0], &r, &scG, ecmult_multi_callback, &data, n, 0));
+        secp256k1_gej_neg(&r2, &r2);
+        secp256k1_gej_add_var(&r, &r, &r2, NULL);
+        CHECK(secp256k1_gej_is_infinity(&r));
+        CHECK(scratch[0]->frame == 0);
+        secp256k1_scratch_destroy(scratch[0]);
+    }
+
+    /* Not even one point fits in an empty scratch space. */
+    scratch[0] = secp256k1_scratch_create(&ctx->error_callback, 819200);
+    scratch[1] = secp256k1_scratch_create(&ctx->error_callback, 0);
+    {
+        secp256k1_gej r;
+        CHECK(!secp256k1_ecmult_multi_var_parallel(&ctx->ecmult_ctx, &forward, scratch, 2, &r, &scG, ecmult_multi_callback, &data, 2));
+    }
+    CHECK(scratch[0]->frame == 0);
+    secp256k1_scratch_destroy(scratch[0]);
+    secp256k1_scratch_destroy(scratch[1]);
+
+    secp256k1_scratch_destroy(big_scratch);
+    free(sc);
+    free(pt);
+}
+
+/* Exercises the affine bucket accumulation with many equal and opposite points in the same buckets. */
+void test_ecmult_multi_pippenger_affine(void) {
+#ifdef USE_ENDOMORPHISM
+    static const size_t n_points = 300;
+#else
+    static const size_t n_points = 700;
+#endif
+    secp256k1_scalar *sc = (secp256k1_scalar *)checked_malloc(&ctx->error_callback, sizeof(secp256k1_scalar) * n_points);
+    secp256k1_ge *pt = (secp256k1_ge *)checked_malloc(&ctx->error_callback, sizeof(secp256k1_ge) * n_points);
+    secp256k1_scratch *scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_strauss_scratch_size(n_points) + secp256k1_pippenger_scratch_size(n_points, PIPPENGER_MAX_BUCKET_WINDOW) + 16*ALIGNMENT);
+    secp256k1_ge base[3];
+    secp256k1_scalar bases[2];
+    secp256k1_gej r, r2;
+    ecmult_multi_data data;
+    size_t i;
+
+    CHECK(secp256k1_pippenger_bucket_window(n_points) >= PIPPENGER_AFFINE_MIN_BUCKET_WINDOW);
+    random_group_element_test(&base[0]);
+    secp256k1_ge_neg(&base[1], &base[0]);
+    random_group_element_test(&base[2]);
+    random_scalar_order(&bases[0]);
+    random_scalar_order(&bases[1]);
+    for (i = 0; i < n_points; i++) {
+        pt[i] = base[secp256k1_rand_int(3)];
+        sc[i] = bases[secp256k1_rand_bits(1)];
+    }
+    data.sc = sc;
+    data.pt = pt;
+
+    CHECK(secp256k1_ecmult_pippenger_batch_single(&ctx->ecmult_ctx, scratch, &r, &bases[0], ecmult_multi_callback, &data, n_points));
+    CHECK(secp256k1_ecmult_strauss_batch_single(&ctx->ecmult_ctx, scratch, &r2, &bases[0], ecmult_multi_callback, &data, n_points));
+    secp256k1_gej_neg(&r2, &r2);
+    secp256k1_gej_add_var(&r, &r, &r2, NULL);
+    CHECK(secp256k1_gej_is_infinity(&r));
+
+    /* Everything cancels out. */
+    for (i = 0; i < n_points; i++) {
+        pt[i] = base[i & 1];
+        sc[i] = bases[0];
+    }
+    CHECK(secp256k1_ecmult_pippenger_batch_single(&ctx->ecmult_ctx, scratch, &r, NULL, ecmult_multi_callback, &data, n_points & ~(size_t)1));
+    CHECK(secp256k1_gej_is_infinity(&r));
+
+    secp256k1_scratch_destroy(scratch);
+    free(sc);
+    free(pt);
+}
+
 void run_ecmult_multi_tests(void) {
     secp256k1_scratch *scratch;
 
@@ -2915,6 +3472,8 @@ void run_ecmult_multi_tests(void) {
     secp256k1_scratch_destroy(scratch);
 
     test_ecmult_multi_batching();
+    test_ecmult_multi_parallel();
+    test_ecmult_multi_pippenger_affine();
 }
 
 void test_wnaf(const secp256k1_scalar *number, int w) {
@@ -3178,41 +3737,126 @@ void run_ecmult_constants(void) {
 void test_ecmult_gen_blind(void) {
     /* Test ecmult_gen() blinding and confirm that the blinding changes, the affine points match, and the z's don't match. */
     secp256k1_scalar key;
-    secp256k1_scalar b;
+    secp256k1_scalar b, b2;
     unsigned char seed32[32];
     secp256k1_gej pgej;
     secp256k1_gej pgej2;
-    secp256k1_gej i;
+    secp256k1_gej i, i2;
     secp256k1_ge pge;
     random_scalar_order_test(&key);
     secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &pgej, &key);
     secp256k1_rand256(seed32);
-    b = ctx->ecmult_gen_ctx.blind;
-    i = ctx->ecmult_gen_ctx.initial;
+    secp256k1_ecmult_gen_load_blinding(&ctx->ecmult_gen_ctx, &b, &i);
     secp256k1_ecmult_gen_blind(&ctx->ecmult_gen_ctx, seed32);
-    CHECK(!secp256k1_scalar_eq(&b, &ctx->ecmult_gen_ctx.blind));
+    secp256k1_ecmult_gen_load_blinding(&ctx->ecmult_gen_ctx, &b2, &i2);
+    CHECK(!secp256k1_scalar_eq(&b, &b2));
     secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &pgej2, &key);
     CHECK(!gej_xyz_equals_gej(&pgej, &pgej2));
-    CHECK(!gej_xyz_equals_gej(&i, &ctx->ecmult_gen_ctx.initial));
+    CHECK(!gej_xyz_equals_gej(&i, &i2));
     secp256k1_ge_set_gej(&pge, &pgej);
     ge_equals_gej(&pge, &pgej2);
 }
 
 void test_ecmult_gen_blind_reset(void) {
     /* Test ecmult_gen() blinding reset and confirm that the blinding is consistent. */
-    secp256k1_scalar b;
-    secp256k1_gej initial;
+    secp256k1_scalar b, b2;
+    secp256k1_gej initial, initial2;
     secp256k1_ecmult_gen_blind(&ctx->ecmult_gen_ctx, 0);
-    b = ctx->ecmult_gen_ctx.blind;
-    initial = ctx->ecmult_gen_ctx.initial;
+    secp256k1_ecmult_gen_load_blinding(&ctx->ecmult_gen_ctx, &b, &initial);
     secp256k1_ecmult_gen_blind(&ctx->ecmult_gen_ctx, 0);
-    CHECK(secp256k1_scalar_eq(&b, &ctx->ecmult_gen_ctx.blind));
-    CHECK(gej_xyz_equals_gej(&initial, &ctx->ecmult_gen_ctx.initial));
+    secp256k1_ecmult_gen_load_blinding(&ctx->ecmult_gen_ctx, &b2, &initial2);
+    CHECK(secp256k1_scalar_eq(&b, &b2));
+    CHECK(gej_xyz_equals_gej(&initial, &initial2));
+}
+
+/* Check ecmult_gen against ecmult for x and -x. */
+static void test_ecmult_gen_compare(const secp256k1_scalar *x) {
+    secp256k1_scalar zero, negx;
+    secp256k1_gej g, r1, r2;
+    secp256k1_ge r;
+    secp256k1_scalar_set_int(&zero, 0);
+    secp256k1_gej_set_ge(&g, &secp256k1_ge_const_g);
+    secp256k1_scalar_negate(&negx, x);
+    secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &r1, x);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &r2, &g, x, &zero);
+    CHECK(secp256k1_gej_is_infinity(&r1) == secp256k1_gej_is_infinity(&r2));
+    if (!secp256k1_gej_is_infinity(&r1)) {
+        secp256k1_ge_set_gej(&r, &r1);
+        ge_equals_gej(&r, &r2);
+    }
+    secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &r1, &negx);
+    secp256k1_gej_neg(&r2, &r2);
+    CHECK(secp256k1_gej_is_infinity(&r1) == secp256k1_gej_is_infinity(&r2));
+    if (!secp256k1_gej_is_infinity(&r1)) {
+        secp256k1_ge_set_gej(&r, &r1);
+        ge_equals_gej(&r, &r2);
+    }
+}
+
+void test_ecmult_gen_blind_publish(void) {
+    /* Test that new blinding values are published as a consistent pair under the sequence lock,
+     * and that readers keep using the previous pair while a replacement is in progress. */
+    secp256k1_ecmult_gen_context *gen_ctx = &ctx->ecmult_gen_ctx;
+    unsigned char seed32[32];
+    unsigned char msg32[32];
+    secp256k1_scalar x, b, b2;
+    secp256k1_gej initial, initial2;
+    secp256k1_ecdsa_signature sig;
+    secp256k1_pubkey pubkey;
+    unsigned char key[32];
+    int slot;
+    size_t seq = secp256k1_seqlock_read_begin(&gen_ctx->seq);
+    CHECK((seq & 1) == 0);
+    CHECK(!secp256k1_seqlock_read_retry(&gen_ctx->seq, seq));
+    secp256k1_ecmult_gen_load_blinding(gen_ctx, &b, &initial);
+    slot = secp256k1_seqlock_write_begin(&gen_ctx->seq);
+    CHECK(slot != secp256k1_seqlock_slot(seq));
+    CHECK(!secp256k1_seqlock_read_retry(&gen_ctx->seq, seq));
+    secp256k1_ecmult_gen_load_blinding(gen_ctx, &b2, &initial2);
+    CHECK(secp256k1_scalar_eq(&b, &b2));
+    CHECK(gej_xyz_equals_gej(&initial, &initial2));
+    /* Publish the unchanged values. */
+    gen_ctx->blind[slot] = b;
+    gen_ctx->initial[slot] = initial;
+    secp256k1_seqlock_write_end(&gen_ctx->seq);
+    CHECK(secp256k1_seqlock_read_retry(&gen_ctx->seq, seq));
+    secp256k1_rand256(seed32);
+    secp256k1_ecmult_gen_blind(gen_ctx, seed32);
+    CHECK(gen_ctx->seq == seq + 4);
+    random_scalar_order_test(&x);
+    test_ecmult_gen_compare(&x);
+
+    /* Sign with the new blinding and check the signature. */
+    secp256k1_scalar_get_b32(key, &x);
+    secp256k1_rand256_test(msg32);
+    CHECK(secp256k1_ecdsa_sign(ctx, &sig, msg32, key, NULL, NULL) == 1);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, key) == 1);
+    CHECK(secp256k1_ecdsa_verify(ctx, &sig, msg32, &pubkey) == 1);
+}
+
+void run_ecmult_gen_comb(void) {
+    /* Scalars whose comb digits are all equal, or differ in a single bit, so that
+     * every table entry and both signs of the top tooth get used. */
+    secp256k1_scalar x, y;
+    int i;
+    secp256k1_scalar_set_int(&x, 0);
+    test_ecmult_gen_compare(&x);
+    secp256k1_scalar_set_int(&x, 1);
+    for (i = 0; i < 256; i++) {
+        test_ecmult_gen_compare(&x);
+        /* 2^i - 1 has its lowest i bits set. */
+        secp256k1_scalar_set_int(&y, 1);
+        secp256k1_scalar_negate(&y, &y);
+        secp256k1_scalar_add(&y, &x, &y);
+        test_ecmult_gen_compare(&y);
+        secp256k1_scalar_add(&x, &x, &x);
+    }
 }
 
 void run_ecmult_gen_blind(void) {
     int i;
     test_ecmult_gen_blind_reset();
+    test_ecmult_gen_blind_publish();
     for (i = 0; i < 10; i++) {
         test_ecmult_gen_blind();
     }
@@ -3886,6 +4530,236 @@ void run_eckey_edge_case_test(void) {
     secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
 }
 
+void test_ec_pubkey_create_batch(void) {
+    secp256k1_pubkey pubkey[8];
+    secp256k1_pubkey pubkey2;
+    unsigned char out33[8 * 33];
+    unsigned char ser[33];
+    unsigned char seckey[8][32];
+    const unsigned char *seckeyptr[8];
+    unsigned char zeros[sizeof(pubkey)] = {0};
+    secp256k1_scratch_space *scratch;
+    size_t scratch_size;
+    size_t n = secp256k1_rand_int(8) + 1;
+    size_t i;
+    int32_t ecount = 0;
+
+    for (i = 0; i < n; i++) {
+        secp256k1_scalar key;
+        random_scalar_order_test(&key);
+        secp256k1_scalar_get_b32(seckey[i], &key);
+        seckeyptr[i] = seckey[i];
+    }
+
+    /* Exercise scratch spaces that hold no batch, part of the batch and all of it. */
+    scratch_size = secp256k1_rand_int(n * (sizeof(secp256k1_gej) + sizeof(secp256k1_ge)) + 1) + 2 * ALIGNMENT;
+    scratch = secp256k1_scratch_space_create(ctx, scratch_size);
+    CHECK(secp256k1_ec_pubkey_create_batch(ctx, scratch, NULL, NULL, NULL, 0) == 1);
+    CHECK(secp256k1_ec_pubkey_create_batch(ctx, scratch, pubkey, out33, seckeyptr, n) == 1);
+    for (i = 0; i < n; i++) {
+        size_t len = 33;
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey2, seckey[i]) == 1);
+        CHECK(memcmp(&pubkey[i], &pubkey2, sizeof(pubkey2)) == 0);
+        CHECK(secp256k1_ec_pubkey_serialize(ctx, ser, &len, &pubkey2, SECP256K1_EC_COMPRESSED) == 1);
+        CHECK(memcmp(&out33[33 * i], ser, 33) == 0);
+    }
+    memset(out33, 0, sizeof(out33));
+    CHECK(secp256k1_ec_pubkey_create_batch(ctx, scratch, NULL, out33, seckeyptr, n) == 1);
+    CHECK(memcmp(&out33[33 * (n - 1)], ser, 33) == 0);
+
+    /* One invalid key clears all outputs. */
+    i = secp256k1_rand_int(n);
+    memset(seckey[i], secp256k1_rand_bits(1) ? 0 : 0xff, 32);
+    CHECK(secp256k1_ec_pubkey_create_batch(ctx, scratch, pubkey, out33, seckeyptr, n) == 0);
+    CHECK(memcmp(pubkey, zeros, n * sizeof(pubkey[0])) == 0);
+    CHECK(memcmp(out33, zeros, n * 33) == 0);
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ec_pubkey_create_batch(ctx, scratch, NULL, NULL, seckeyptr, n) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ec_pubkey_create_batch(ctx, NULL, pubkey, NULL, seckeyptr, n) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ec_pubkey_create_batch(ctx, scratch, pubkey, NULL, NULL, n) == 0);
+    CHECK(ecount == 3);
+    seckeyptr[i] = NULL;
+    CHECK(secp256k1_ec_pubkey_create_batch(ctx, scratch, pubkey, NULL, seckeyptr, n) == 0);
+    CHECK(ecount == 4);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_scratch_space_destroy(scratch);
+}
+
+void test_ge_add_all_ge(void) {
+    secp256k1_ge a, b[8], r[8];
+    secp256k1_gej aj, rj;
+    secp256k1_fe d[8];
+    size_t n = secp256k1_rand_int(8) + 1;
+    size_t i;
+
+    random_group_element_test(&a);
+    secp256k1_gej_set_ge(&aj, &a);
+    for (i = 0; i < 8; i++) {
+        random_group_element_test(&b[i]);
+    }
+    CHECK(secp256k1_ge_add_all_ge(r, d, &a, b, n) == 1);
+    for (i = 0; i < n; i++) {
+        secp256k1_gej_add_ge_var(&rj, &aj, &b[i], NULL);
+        ge_equals_gej(&r[i], &rj);
+    }
+    /* Inputs with the x coordinate of a are rejected. */
+    i = secp256k1_rand_int(n);
+    b[i] = a;
+    if (secp256k1_rand_bits(1)) {
+        secp256k1_ge_neg(&b[i], &b[i]);
+    }
+    CHECK(secp256k1_ge_add_all_ge(r, d, &a, b, n) == 0);
+}
+
+void test_ec_pubkey_create_sequence(void) {
+    secp256k1_pubkey pubkey[160];
+    secp256k1_pubkey pubkey2;
+    unsigned char out33[160 * 33];
+    unsigned char ser[33];
+    unsigned char seckey[32];
+    unsigned char zeros[sizeof(pubkey)] = {0};
+    secp256k1_scratch_space *scratch;
+    secp256k1_scalar key, one, nkey;
+    size_t scratch_size;
+    /* Sequences of 128 keys or more are split into batches that share multiples of G. */
+    size_t n = secp256k1_rand_int(secp256k1_rand_bits(1) ? 16 : 160) + 1;
+    size_t i;
+
+    random_scalar_order_test(&key);
+    secp256k1_scalar_set_int(&one, 1);
+    /* Sometimes end the sequence right below the group order, or start it at a multiple of
+     * G that some key of the batch doubles. */
+    switch (secp256k1_rand_int(4)) {
+    case 0:
+        secp256k1_scalar_set_int(&key, n);
+        secp256k1_scalar_negate(&key, &key);
+        break;
+    case 1:
+        secp256k1_scalar_set_int(&key, secp256k1_rand_int(n) + 1);
+        break;
+    }
+    secp256k1_scalar_get_b32(seckey, &key);
+
+    /* Exercise scratch spaces that hold no batch, part of the batch and all of it. */
+    scratch_size = secp256k1_rand_int(n * (2 * sizeof(secp256k1_ge) + sizeof(secp256k1_gej) + sizeof(secp256k1_fe)) + sizeof(secp256k1_ge) + 1) + 4 * ALIGNMENT;
+    scratch = secp256k1_scratch_space_create(ctx, scratch_size);
+    CHECK(secp256k1_ec_pubkey_create_sequence(ctx, scratch, NULL, NULL, seckey, 0) == 1);
+    CHECK(secp256k1_ec_pubkey_create_sequence(ctx, scratch, pubkey, out33, seckey, n) == 1);
+    nkey = key;
+    for (i = 0; i < n; i++) {
+        unsigned char nseckey[32];
+        size_t len = 33;
+        secp256k1_scalar_get_b32(nseckey, &nkey);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey2, nseckey) == 1);
+        CHECK(memcmp(&pubkey[i], &pubkey2, sizeof(pubkey2)) == 0);
+        CHECK(secp256k1_ec_pubkey_serialize(ctx, ser, &len, &pubkey2, SECP256K1_EC_COMPRESSED) == 1);
+        CHECK(memcmp(&out33[33 * i], ser, 33) == 0);
+        secp256k1_scalar_add(&nkey, &nkey, &one);
+    }
+
+    /* A sequence reaching the group order fails and clears all outputs. */
+    secp256k1_scalar_set_int(&key, n - secp256k1_rand_int(n));
+    secp256k1_scalar_negate(&key, &key);
+    secp256k1_scalar_add(&key, &key, &one);
+    secp256k1_scalar_get_b32(seckey, &key);
+    CHECK(secp256k1_ec_pubkey_create_sequence(ctx, scratch, pubkey, out33, seckey, n) == 0);
+    CHECK(memcmp(pubkey, zeros, n * sizeof(pubkey[0])) == 0);
+    CHECK(memcmp(out33, zeros, n * 33) == 0);
+    memset(seckey, 0, 32);
+    CHECK(secp256k1_ec_pubkey_create_sequence(ctx, scratch, pubkey, NULL, seckey, n) == 0);
+    secp256k1_scratch_space_destroy(scratch);
+}
+
+void test_ec_pubkey_tweak_add_batch(void) {
+    secp256k1_pubkey pubkey[8];
+    secp256k1_pubkey pubkey2[8];
+    unsigned char tweak[8][32];
+    const unsigned char *tweakptr[8];
+    unsigned char zeros[sizeof(secp256k1_pubkey)] = {0};
+    secp256k1_scalar key[8];
+    secp256k1_scratch_space *scratch;
+    secp256k1_gej rj;
+    secp256k1_ge r;
+    size_t scratch_size;
+    size_t n = secp256k1_rand_int(8) + 1;
+    size_t i, bad;
+    int32_t ecount = 0;
+
+    for (i = 0; i < n; i++) {
+        unsigned char seckey[32];
+        secp256k1_scalar t;
+        random_scalar_order_test(&key[i]);
+        secp256k1_scalar_get_b32(seckey, &key[i]);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey[i], seckey) == 1);
+        random_scalar_order_test(&t);
+        secp256k1_scalar_get_b32(tweak[i], &t);
+        tweakptr[i] = tweak[i];
+
+        /* The G-only path agrees with ecmult_gen. */
+        secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &rj, &t);
+        secp256k1_ge_set_gej(&r, &rj);
+        secp256k1_ecmult_g_var(&ctx->ecmult_ctx, &rj, &t);
+        ge_equals_gej(&r, &rj);
+    }
+    memcpy(pubkey2, pubkey, sizeof(pubkey));
+
+    /* Exercise scratch spaces that hold no batch, part of the batch and all of it. */
+    scratch_size = secp256k1_rand_int(n * 300 + 1) + 5 * ALIGNMENT;
+    scratch = secp256k1_scratch_space_create(ctx, scratch_size);
+    CHECK(secp256k1_ec_pubkey_tweak_add_batch(ctx, scratch, NULL, NULL, 0) == 1);
+    CHECK(secp256k1_ec_pubkey_tweak_add_batch(ctx, scratch, pubkey, tweakptr, n) == 1);
+    for (i = 0; i < n; i++) {
+        CHECK(secp256k1_ec_pubkey_tweak_add(ctx, &pubkey2[i], tweak[i]) == 1);
+        CHECK(memcmp(&pubkey[i], &pubkey2[i], sizeof(pubkey[i])) == 0);
+    }
+
+    /* A tweak that overflows or cancels the key only clears that key. */
+    bad = secp256k1_rand_int(n);
+    if (secp256k1_rand_bits(1)) {
+        memset(tweak[bad], 0xff, 32);
+    } else {
+        /* The key was tweaked once already, so its secret key is key + tweak. */
+        secp256k1_scalar t;
+        secp256k1_scalar_set_b32(&t, tweak[bad], NULL);
+        secp256k1_scalar_add(&t, &t, &key[bad]);
+        secp256k1_scalar_negate(&t, &t);
+        secp256k1_scalar_get_b32(tweak[bad], &t);
+    }
+    CHECK(secp256k1_ec_pubkey_tweak_add_batch(ctx, scratch, pubkey, tweakptr, n) == 0);
+    for (i = 0; i < n; i++) {
+        if (i == bad) {
+            CHECK(memcmp(&pubkey[i], zeros, sizeof(pubkey[i])) == 0);
+        } else {
+            CHECK(secp256k1_ec_pubkey_tweak_add(ctx, &pubkey2[i], tweak[i]) == 1);
+            CHECK(memcmp(&pubkey[i], &pubkey2[i], sizeof(pubkey[i])) == 0);
+        }
+    }
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ec_pubkey_tweak_add_batch(ctx, NULL, pubkey2, tweakptr, n) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ec_pubkey_tweak_add_batch(ctx, scratch, NULL, tweakptr, n) == 0);
+    CHECK(ecount == 2);
+    tweakptr[bad] = NULL;
+    CHECK(secp256k1_ec_pubkey_tweak_add_batch(ctx, scratch, pubkey2, tweakptr, n) == 0);
+    CHECK(ecount == 3);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_scratch_space_destroy(scratch);
+}
+
+void run_ec_pubkey_create_batch(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_ec_pubkey_create_batch();
+        test_ge_add_all_ge();
+        test_ec_pubkey_create_sequence();
+        test_ec_pubkey_tweak_add_batch();
+    }
+}
+
 void random_sign(secp256k1_scalar *sigr, secp256k1_scalar *sigs, const secp256k1_scalar *key, const secp256k1_scalar *msg, int *recid) {
     secp256k1_scalar nonce;
     do {
@@ -3923,6 +4797,147 @@ void run_ecdsa_sign_verify(void) {
     }
 }
 
+void test_ecdsa_verify_batch(void) {
+    secp256k1_ecdsa_signature sig[8];
+    secp256k1_pubkey pubkey[8];
+    unsigned char msg[8][32];
+    const secp256k1_ecdsa_signature *sigptr[8];
+    const unsigned char *msgptr[8];
+    const secp256k1_pubkey *pubkeyptr[8];
+    secp256k1_scratch_space *scratch;
+    size_t scratch_size;
+    size_t n = secp256k1_rand_int(8) + 1;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        unsigned char seckey[32];
+        secp256k1_scalar key;
+        random_scalar_order_test(&key);
+        secp256k1_scalar_get_b32(seckey, &key);
+        secp256k1_rand256_test(msg[i]);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey[i], seckey) == 1);
+        CHECK(secp256k1_ecdsa_sign(ctx, &sig[i], msg[i], seckey, NULL, NULL) == 1);
+        sigptr[i] = &sig[i];
+        msgptr[i] = msg[i];
+        pubkeyptr[i] = &pubkey[i];
+    }
+
+    /* Exercise scratch spaces that hold no batch, part of the batch and all of it. */
+    scratch_size = secp256k1_rand_int(2 * n * sizeof(secp256k1_scalar) + 1) + 2 * ALIGNMENT;
+    scratch = secp256k1_scratch_space_create(ctx, scratch_size);
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sigptr, msgptr, pubkeyptr, 0) == 1);
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sigptr, msgptr, pubkeyptr, n) == 1);
+
+    /* Any single bad signature causes the batch to fail. */
+    i = secp256k1_rand_int(n);
+    msg[i][0] ^= 1;
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sigptr, msgptr, pubkeyptr, n) == 0);
+    msg[i][0] ^= 1;
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sigptr, msgptr, pubkeyptr, n) == 1);
+    if (n > 1) {
+        pubkeyptr[i] = &pubkey[(i + 1) % n];
+        CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sigptr, msgptr, pubkeyptr, n) == 0);
+    }
+    secp256k1_scratch_space_destroy(scratch);
+}
+
+void test_ecdsa_verify_batch_high_s(void) {
+    secp256k1_ecdsa_signature sig[2];
+    secp256k1_pubkey pubkey;
+    unsigned char msg[32];
+    unsigned char seckey[32];
+    const secp256k1_ecdsa_signature *sigptr[2];
+    const unsigned char *msgptr[2];
+    const secp256k1_pubkey *pubkeyptr[2];
+    secp256k1_scratch_space *scratch;
+    secp256k1_scalar key, r, s;
+
+    random_scalar_order_test(&key);
+    secp256k1_scalar_get_b32(seckey, &key);
+    secp256k1_rand256_test(msg);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, seckey) == 1);
+    CHECK(secp256k1_ecdsa_sign(ctx, &sig[0], msg, seckey, NULL, NULL) == 1);
+    secp256k1_ecdsa_signature_load(ctx, &r, &s, &sig[0]);
+    secp256k1_scalar_negate(&s, &s);
+    secp256k1_ecdsa_signature_save(&sig[1], &r, &s);
+    sigptr[0] = &sig[0];
+    sigptr[1] = &sig[1];
+    msgptr[0] = msgptr[1] = msg;
+    pubkeyptr[0] = pubkeyptr[1] = &pubkey;
+
+    scratch = secp256k1_scratch_space_create(ctx, 1000);
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sigptr, msgptr, pubkeyptr, 1) == 1);
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sigptr, msgptr, pubkeyptr, 2) == 0);
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, &sigptr[1], msgptr, pubkeyptr, 1) == 0);
+    secp256k1_scratch_space_destroy(scratch);
+}
+
+void run_ecdsa_verify_batch(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_ecdsa_verify_batch();
+    }
+    test_ecdsa_verify_batch_high_s();
+}
+
+void test_ecdsa_verify_precomp(void) {
+    secp256k1_ecdsa_signature sig;
+    secp256k1_pubkey pubkey, pubkey2;
+    secp256k1_pubkey_precomp *precomp;
+    unsigned char msg[32];
+    unsigned char seckey[32];
+    secp256k1_scalar key, r, s;
+    int ecount = 0;
+    int i;
+
+    random_scalar_order_test(&key);
+    secp256k1_scalar_get_b32(seckey, &key);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, seckey) == 1);
+    precomp = secp256k1_pubkey_precomp_create(ctx, &pubkey);
+    CHECK(precomp != NULL);
+    for (i = 0; i < 4; i++) {
+        secp256k1_rand256_test(msg);
+        CHECK(secp256k1_ecdsa_sign(ctx, &sig, msg, seckey, NULL, NULL) == 1);
+        CHECK(secp256k1_ecdsa_verify_precomp(ctx, &sig, msg, precomp) == 1);
+        msg[secp256k1_rand_int(32)] ^= 1 << secp256k1_rand_int(8);
+        CHECK(secp256k1_ecdsa_verify_precomp(ctx, &sig, msg, precomp) == secp256k1_ecdsa_verify(ctx, &sig, msg, &pubkey));
+    }
+
+    /* High s is rejected like by secp256k1_ecdsa_verify. */
+    CHECK(secp256k1_ecdsa_sign(ctx, &sig, msg, seckey, NULL, NULL) == 1);
+    secp256k1_ecdsa_signature_load(ctx, &r, &s, &sig);
+    secp256k1_scalar_negate(&s, &s);
+    secp256k1_ecdsa_signature_save(&sig, &r, &s);
+    CHECK(secp256k1_ecdsa_verify_precomp(ctx, &sig, msg, precomp) == 0);
+    secp256k1_pubkey_precomp_destroy(precomp);
+
+    /* A signature by a different key fails. */
+    secp256k1_scalar_negate(&s, &s);
+    secp256k1_ecdsa_signature_save(&sig, &r, &s);
+    random_scalar_order_test(&key);
+    secp256k1_scalar_get_b32(seckey, &key);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey2, seckey) == 1);
+    precomp = secp256k1_pubkey_precomp_create(ctx, &pubkey2);
+    CHECK(precomp != NULL);
+    CHECK(secp256k1_ecdsa_verify_precomp(ctx, &sig, msg, precomp) == 0);
+    secp256k1_pubkey_precomp_destroy(precomp);
+
+    /* Invalid public keys are rejected. */
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    memset(&pubkey, 0, sizeof(pubkey));
+    CHECK(secp256k1_pubkey_precomp_create(ctx, &pubkey) == NULL);
+    CHECK(ecount == 1);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_pubkey_precomp_destroy(NULL);
+}
+
+void run_ecdsa_verify_precomp(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_ecdsa_verify_precomp();
+    }
+}
+
 /** Dummy nonce generation function that just uses a precomputed nonce, and fails if it is not accepted. Use only for testing. */
 static int precomputed_nonce_function(unsigned char *nonce32, const unsigned char *msg32, const unsigned char *key32, const unsigned char *algo16, void *data, unsigned int counter) {
     (void)msg32;
@@ -3970,6 +4985,111 @@ static int nonce_function_test_retry(unsigned char *nonce32, const unsigned char
    return nonce_function_rfc6979(nonce32, msg32, key32, algo16, data, counter - 5);
 }
 
+void test_ecdsa_sign_batch(void) {
+    secp256k1_ecdsa_signature sig[8];
+    secp256k1_ecdsa_signature sig2;
+    unsigned char msg[8][32];
+    const unsigned char *msgptr[8];
+    unsigned char seckey[32];
+    unsigned char zeros[sizeof(sig)] = {0};
+    secp256k1_scratch_space *scratch;
+    secp256k1_nonce_function noncefp;
+    secp256k1_scalar key;
+    size_t scratch_size;
+    size_t n = secp256k1_rand_int(8) + 1;
+    size_t i;
+
+    random_scalar_order_test(&key);
+    secp256k1_scalar_get_b32(seckey, &key);
+    for (i = 0; i < n; i++) {
+        secp256k1_rand256_test(msg[i]);
+        msgptr[i] = msg[i];
+    }
+    /* Sometimes use a nonce function that rejects the first nonces. */
+    noncefp = secp256k1_rand_bits(1) ? nonce_function_test_retry : NULL;
+
+    /* Exercise scratch spaces that hold no batch, part of the batch and all of it. */
+    scratch_size = secp256k1_rand_int(n * (2 * sizeof(secp256k1_scalar) + sizeof(secp256k1_gej) + sizeof(secp256k1_ge)) + 1) + 4 * ALIGNMENT;
+    scratch = secp256k1_scratch_space_create(ctx, scratch_size);
+    CHECK(secp256k1_ecdsa_sign_batch(ctx, scratch, NULL, NULL, 0, seckey, NULL, NULL) == 1);
+    CHECK(secp256k1_ecdsa_sign_batch(ctx, scratch, sig, msgptr, n, seckey, noncefp, NULL) == 1);
+    for (i = 0; i < n; i++) {
+        CHECK(secp256k1_ecdsa_sign(ctx, &sig2, msg[i], seckey, noncefp, NULL) == 1);
+        CHECK(memcmp(&sig[i], &sig2, sizeof(sig2)) == 0);
+    }
+
+    /* Failures clear all signatures. */
+    CHECK(secp256k1_ecdsa_sign_batch(ctx, scratch, sig, msgptr, n, seckey, nonce_function_test_fail, NULL) == 0);
+    CHECK(memcmp(sig, zeros, n * sizeof(sig[0])) == 0);
+    CHECK(secp256k1_ecdsa_sign_batch(ctx, scratch, sig, msgptr, n, zeros, NULL, NULL) == 0);
+    CHECK(memcmp(sig, zeros, n * sizeof(sig[0])) == 0);
+    secp256k1_scratch_space_destroy(scratch);
+}
+
+void test_ecdsa_sign_batch_api(void) {
+    secp256k1_context *vrfy = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(ctx, 1000);
+    secp256k1_ecdsa_signature sig;
+    unsigned char msg[32] = {0};
+    const unsigned char *msgptr[1];
+    unsigned char seckey[32] = {0};
+    int32_t ecount = 0;
+
+    seckey[31] = 1;
+    msgptr[0] = NULL;
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(vrfy, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ecdsa_sign_batch(vrfy, scratch, &sig, msgptr, 1, seckey, NULL, NULL) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdsa_sign_batch(ctx, NULL, &sig, msgptr, 1, seckey, NULL, NULL) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecdsa_sign_batch(ctx, scratch, NULL, msgptr, 1, seckey, NULL, NULL) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_ecdsa_sign_batch(ctx, scratch, &sig, msgptr, 1, seckey, NULL, NULL) == 0);
+    CHECK(ecount == 4);
+    msgptr[0] = msg;
+    CHECK(secp256k1_ecdsa_sign_batch(ctx, scratch, &sig, msgptr, 1, NULL, NULL, NULL) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_ecdsa_sign_batch(ctx, scratch, &sig, msgptr, 1, seckey, NULL, NULL) == 1);
+    CHECK(ecount == 5);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_scratch_space_destroy(scratch);
+    secp256k1_context_destroy(vrfy);
+}
+
+void test_ge_set_all_gej(void) {
+    secp256k1_gej gej[8];
+    secp256k1_ge ge[8];
+    secp256k1_scalar a[8], ai[8], blind, x;
+    size_t n = secp256k1_rand_int(8) + 1;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        random_group_element_jacobian_test(&gej[i], &secp256k1_ge_const_g);
+        random_scalar_order_test(&a[i]);
+    }
+    secp256k1_ge_set_all_gej(ge, gej, n);
+    secp256k1_scalar_set_int(&blind, 1);
+    if (secp256k1_rand_bits(1)) {
+        random_scalar_order_test(&blind);
+    }
+    secp256k1_scalar_inverse_all(ai, a, n, &blind);
+    for (i = 0; i < n; i++) {
+        ge_equals_gej(&ge[i], &gej[i]);
+        secp256k1_scalar_inverse(&x, &a[i]);
+        CHECK(secp256k1_scalar_eq(&x, &ai[i]));
+    }
+}
+
+void run_ecdsa_sign_batch(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_ge_set_all_gej();
+        test_ecdsa_sign_batch();
+    }
+    test_ecdsa_sign_batch_api();
+}
+
 int is_empty_signature(const secp256k1_ecdsa_signature *sig) {
     static const unsigned char res[sizeof(secp256k1_ecdsa_signature)] = {0};
     return memcmp(sig, res, sizeof(secp256k1_ecdsa_signature)) == 0;
@@ -4948,6 +6068,10 @@ void run_ecdsa_openssl(void) {
 # include "modules/recovery/tests_impl.h"
 #endif
 
+#ifdef ENABLE_MODULE_TABLEFILE
+# include "modules/tablefile/tests_impl.h"
+#endif
+
 int main(int argc, char **argv) {
     unsigned char seed16[16] = {0};
     unsigned char run32[32] = {0};
@@ -5015,26 +6139,33 @@ int main(int argc, char **argv) {
 
     /* scalar tests */
     run_scalar_tests();
+    run_scalar_inv_special();
 
     /* field tests */
     run_field_inv();
     run_field_inv_var();
+    run_field_inv_special();
     run_field_inv_all_var();
     run_field_misc();
     run_field_convert();
     run_sqr();
     run_sqrt();
+    run_fe_is_quad();
+    run_kernels();
 
     /* group tests */
     run_ge();
     run_group_decompress();
 
     /* ecmult tests */
+    run_context_window_tests();
     run_wnaf();
     run_point_times_order();
+    run_ecmult_with_table();
     run_ecmult_chain();
     run_ecmult_constants();
     run_ecmult_gen_blind();
+    run_ecmult_gen_comb();
     run_ecmult_const_tests();
     run_ecmult_multi_tests();
     run_ec_combine();
@@ -5049,6 +6180,7 @@ int main(int argc, char **argv) {
 
     /* EC key edge cases */
     run_eckey_edge_case_test();
+    run_ec_pubkey_create_batch();
 
 #ifdef ENABLE_MODULE_ECDH
     /* ecdh tests */
@@ -5059,6 +6191,9 @@ int main(int argc, char **argv) {
     run_random_pubkeys();
     run_ecdsa_der_parse();
     run_ecdsa_sign_verify();
+    run_ecdsa_verify_batch();
+    run_ecdsa_sign_batch();
+    run_ecdsa_verify_precomp();
     run_ecdsa_end_to_end();
     run_ecdsa_edge_cases();
 #ifdef ENABLE_OPENSSL_TESTS
@@ -5070,6 +6205,11 @@ int main(int argc, char **argv) {
     run_recovery_tests();
 #endif
 
+#ifdef ENABLE_MODULE_TABLEFILE
+    /* table file tests */
+    run_tablefile_tests();
+#endif
+
     secp256k1_rand256(run32);
     printf("random run = %02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x\n", run32[0], run32[1], run32[2], run32[3], run32[4], run32[5], run32[6], run32[7], run32[8], run32[9], run32[10], run32[11], run32[12], run32[13], run32[14], run32[15]);
 
@@ -84,6 +84,108 @@ static SECP256K1_INLINE void *checked_realloc(const secp256k1_callback* cb, void
     return ret;
 }
 
+/** Reference count for immutable data shared between contexts. Sharing needs atomic
+ *  builtins, as contexts holding the data may be destroyed from different threads.
+ *  Without them secp256k1_refcount_share always fails and callers make a copy instead. */
+typedef struct secp256k1_refcount_struct {
+    size_t n;
+    /* If not NULL, frees the data and the count itself after the last release. */
+    void (*destroy)(struct secp256k1_refcount_struct *r);
+} secp256k1_refcount;
+
+static SECP256K1_INLINE secp256k1_refcount *secp256k1_refcount_create(const secp256k1_callback* cb) {
+    secp256k1_refcount *ret = (secp256k1_refcount*)checked_malloc(cb, sizeof(secp256k1_refcount));
+    ret->n = 1;
+    ret->destroy = NULL;
+    return ret;
+}
+
+/** Add a reference. Returns 1 on success, 0 if the data cannot be shared. */
+static SECP256K1_INLINE int secp256k1_refcount_share(secp256k1_refcount *r) {
+#ifdef HAVE_BUILTIN_ATOMICS
+    __atomic_add_fetch(&r->n, 1, __ATOMIC_RELAXED);
+    return 1;
+#else
+    (void)r;
+    return 0;
+#endif
+}
+
+/** Drop a reference. Returns 1 if it was the last one and r has no destroy function,
+ *  in which case r has been freed and the caller has to free the data. */
+static SECP256K1_INLINE int secp256k1_refcount_release(secp256k1_refcount *r) {
+#ifdef HAVE_BUILTIN_ATOMICS
+    if (__atomic_sub_fetch(&r->n, 1, __ATOMIC_ACQ_REL) != 0) {
+        return 0;
+    }
+#else
+    /* Never shared between contexts, so only released by a single thread. */
+    if (--r->n != 0) {
+        return 0;
+    }
+#endif
+    if (r->destroy != NULL) {
+        r->destroy(r);
+        return 0;
+    }
+    free(r);
+    return 1;
+}
+
+/** Sequence lock over two copies of data that is read far more often than it is written.
+ *  Readers never wait for a writer: secp256k1_seqlock_read_begin returns a count whose
+ *  secp256k1_seqlock_slot names the published copy, and readers start over if
+ *  secp256k1_seqlock_read_retry returns 1 because a newer copy was published while they
+ *  were reading. A writer fills the other copy between secp256k1_seqlock_write_begin, which
+ *  returns its slot, and secp256k1_seqlock_write_end, which publishes it. Writers exclude
+ *  each other; the count is odd while a write is in progress. Without atomic builtins this
+ *  does not synchronize anything, and callers need exclusive access to write. */
+static SECP256K1_INLINE int secp256k1_seqlock_slot(size_t seq) {
+    return (seq >> 1) & 1;
+}
+
+static SECP256K1_INLINE size_t secp256k1_seqlock_read_begin(const size_t *seq) {
+#ifdef HAVE_BUILTIN_ATOMICS
+    return __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+#else
+    return *seq;
+#endif
+}
+
+static SECP256K1_INLINE int secp256k1_seqlock_read_retry(const size_t *seq, size_t start) {
+    /* An in-progress write fills the other copy, so only a completed one invalidates the read. */
+#ifdef HAVE_BUILTIN_ATOMICS
+    /* Order the reads of the data before the check of the count. */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return (__atomic_load_n(seq, __ATOMIC_RELAXED) >> 1) != (start >> 1);
+#else
+    return (*seq >> 1) != (start >> 1);
+#endif
+}
+
+static SECP256K1_INLINE int secp256k1_seqlock_write_begin(size_t *seq) {
+#ifdef HAVE_BUILTIN_ATOMICS
+    size_t s = __atomic_load_n(seq, __ATOMIC_RELAXED);
+    while ((s & 1) || !__atomic_compare_exchange_n(seq, &s, s + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        s = __atomic_load_n(seq, __ATOMIC_RELAXED);
+    }
+    /* Order the start of the write before the writes of the data, so that a reader of
+     * the copy about to be overwritten sees a newer count when it retries. */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+#else
+    size_t s = (*seq)++;
+#endif
+    return secp256k1_seqlock_slot(s + 2);
+}
+
+static SECP256K1_INLINE void secp256k1_seqlock_write_end(size_t *seq) {
+#ifdef HAVE_BUILTIN_ATOMICS
+    __atomic_add_fetch(seq, 1, __ATOMIC_RELEASE);
+#else
+    ++*seq;
+#endif
+}
+
 /* Macro for restrict, when available and not in a VERIFY build. */
 #if defined(SECP256K1_BUILD) && defined(VERIFY)
 # define SECP256K1_RESTRICT
@@ -116,6 +218,52 @@ static SECP256K1_INLINE void *checked_realloc(const secp256k1_callback* cb, void
 #  define SECP256K1_GNUC_EXT
 # endif
 SECP256K1_GNUC_EXT typedef unsigned __int128 uint128_t;
+SECP256K1_GNUC_EXT typedef __int128 int128_t;
 #endif
 
+/* Determine the number of trailing zero bits in a (non-zero) 32-bit x, using a de Bruijn sequence. */
+static SECP256K1_INLINE int secp256k1_ctz32_var_debruijn(uint32_t x) {
+    static const uint8_t debruijn[32] = {
+        0x00, 0x01, 0x02, 0x18, 0x03, 0x13, 0x06, 0x19, 0x16, 0x04, 0x14, 0x0A,
+        0x10, 0x07, 0x0C, 0x1A, 0x1F, 0x17, 0x12, 0x05, 0x15, 0x09, 0x0F, 0x0B,
+        0x1E, 0x11, 0x08, 0x0E, 0x1D, 0x0D, 0x1C, 0x1B
+    };
+    return debruijn[((x & -x) * 0x04D7651FU) >> 27];
+}
+
+/* Determine the number of trailing zero bits in a (non-zero) 64-bit x, using a de Bruijn sequence. */
+static SECP256K1_INLINE int secp256k1_ctz64_var_debruijn(uint64_t x) {
+    static const uint8_t debruijn[64] = {
+        0x00, 0x01, 0x02, 0x35, 0x03, 0x07, 0x36, 0x1B, 0x04, 0x26, 0x29, 0x08,
+        0x22, 0x37, 0x30, 0x1C, 0x3E, 0x05, 0x27, 0x2E, 0x2C, 0x2A, 0x16, 0x09,
+        0x18, 0x23, 0x3B, 0x38, 0x31, 0x12, 0x1D, 0x0B, 0x3F, 0x34, 0x06, 0x1A,
+        0x25, 0x28, 0x21, 0x2F, 0x3D, 0x2D, 0x2B, 0x15, 0x17, 0x3A, 0x11, 0x0A,
+        0x33, 0x19, 0x24, 0x20, 0x3C, 0x14, 0x39, 0x10, 0x32, 0x1F, 0x13, 0x0F,
+        0x1E, 0x0E, 0x0D, 0x0C
+    };
+    return debruijn[((x & -x) * 0x022FDD63CC95386DULL) >> 58];
+}
+
+/* Determine the number of trailing zero bits in a (non-zero) 32-bit x. */
+static SECP256K1_INLINE int secp256k1_ctz32_var(uint32_t x) {
+    VERIFY_CHECK(x != 0);
+#if defined(__GNUC__) && SECP256K1_GNUC_PREREQ(3, 4)
+    if (((unsigned)UINT32_MAX) == UINT32_MAX) {
+        return __builtin_ctz(x);
+    }
+#endif
+    return secp256k1_ctz32_var_debruijn(x);
+}
+
+/* Determine the number of trailing zero bits in a (non-zero) 64-bit x. */
+static SECP256K1_INLINE int secp256k1_ctz64_var(uint64_t x) {
+    VERIFY_CHECK(x != 0);
+#if defined(__GNUC__) && SECP256K1_GNUC_PREREQ(3, 4)
+    if (((unsigned long long)UINT64_MAX) == UINT64_MAX) {
+        return __builtin_ctzll(x);
+    }
+#endif
+    return secp256k1_ctz64_var_debruijn(x);
+}
+
 #endif /* SECP256K1_UTIL_H */